@@ -6,6 +6,8 @@ const binding = require('../bazel-bin/examples/binding.node');
 
 console.log(`1 + 2 = ${binding.Calculator.add(1, 2)}`);
 console.log(`1 - 2 = ${binding.Calculator.sub(1, 2)}`);
+console.log(`[1, 2] + [3, 4] = ${
+  binding.Calculator.addBatch(new Int32Array([1, 2]), new Int32Array([3, 4]))}`);
 const c = new binding.Calculator();
 console.log(`${c.result()} + 1 = ${c.increment(), c.result()}`);
 console.log(`${c.result()} + 3 = ${c.increment(3), c.result()}`);
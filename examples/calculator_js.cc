@@ -4,28 +4,32 @@
 
 #include "examples/calculator_js.h"
 
+#include "node_binding/batch.h"
+#include "node_binding/bind.h"
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
 #include "node_binding/typed_call.h"
 
 using namespace node_binding;
 
-Napi::FunctionReference CalculatorJs::constructor_;
-
 // static
 void CalculatorJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func =
       DefineClass(env, "Calculator",
                   {
-                      StaticMethod("add", &CalculatorJs::Add),
-                      StaticMethod("sub", &CalculatorJs::Sub),
+                      NODE_BINDING_BIND(&Calculator::Add)::Descriptor(
+                          "add", napi_static),
+                      NODE_BINDING_BIND(&Calculator::Sub)::Descriptor(
+                          "sub", napi_static),
+                      NODE_BINDING_BIND_BATCH(&Calculator::Add)::Descriptor(
+                          "addBatch", napi_static),
                       InstanceMethod("result", &CalculatorJs::result),
                       InstanceMethod("increment", &CalculatorJs::Increment),
                       InstanceMethod("decrement", &CalculatorJs::Decrement),
                       InstanceMethod("clear", &CalculatorJs::Clear),
                   });
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  SetConstructor<CalculatorJs>(env, func);
 
   exports.Set("Calculator", func);
 }
@@ -46,34 +50,20 @@ CalculatorJs::CalculatorJs(const Napi::CallbackInfo& info)
   if (env.IsExceptionPending()) calculator_.reset();
 }
 
-// static
-Napi::Value CalculatorJs::Add(const Napi::CallbackInfo& info) {
-  return TypedCall(info, &Calculator::Add);
-}
-
-// static
-Napi::Value CalculatorJs::Sub(const Napi::CallbackInfo& info) {
-  return TypedCall(info, &Calculator::Sub);
-}
-
 Napi::Value CalculatorJs::result(const Napi::CallbackInfo& info) {
   return TypedCall(info, &Calculator::result, calculator_.get());
 }
 
 void CalculatorJs::Increment(const Napi::CallbackInfo& info) {
-  if (info.Length() == 0) {
-    TypedCall(info, &Calculator::Increment, calculator_.get(), 1);
-  } else {
-    TypedCall(info, &Calculator::Increment, calculator_.get());
-  }
+  static const auto overloads =
+      Overloads(Overload(&Calculator::Increment, 1), &Calculator::Increment);
+  TypedCall(info, overloads, calculator_.get());
 }
 
 void CalculatorJs::Decrement(const Napi::CallbackInfo& info) {
-  if (info.Length() == 0) {
-    TypedCall(info, &Calculator::Decrement, calculator_.get(), 1);
-  } else {
-    TypedCall(info, &Calculator::Decrement, calculator_.get());
-  }
+  static const auto overloads =
+      Overloads(Overload(&Calculator::Decrement, 1), &Calculator::Decrement);
+  TypedCall(info, overloads, calculator_.get());
 }
 
 void CalculatorJs::Clear(const Napi::CallbackInfo& info) {
@@ -5,12 +5,11 @@
 #include "examples/point_js.h"
 
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
 #include "node_binding/type_convertor.h"
 
 using namespace node_binding;
 
-Napi::FunctionReference PointJs::constructor_;
-
 // static
 void PointJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func =
@@ -20,8 +19,7 @@ void PointJs::Init(Napi::Env env, Napi::Object exports) {
                       InstanceAccessor("y", &PointJs::GetY, &PointJs::SetY),
                   });
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  SetConstructor<PointJs>(env, func);
 
   exports.Set("Point", func);
 }
@@ -30,7 +28,7 @@ void PointJs::Init(Napi::Env env, Napi::Object exports) {
 Napi::Object PointJs::New(Napi::Env env, const Point& p) {
   Napi::EscapableHandleScope scope(env);
 
-  Napi::Object object = constructor_.New({
+  Napi::Object object = NewInstance<PointJs>(env, {
       Napi::Number::New(env, p.x),
       Napi::Number::New(env, p.y),
   });
@@ -40,16 +38,11 @@ Napi::Object PointJs::New(Napi::Env env, const Point& p) {
 
 PointJs::PointJs(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<PointJs>(info) {
-  if (info.Length() == 0) {
-    point_ = TypedConstruct(info, &Constructor<Point>::Call<int, int>, 0, 0);
-  } else if (info.Length() == 1) {
-    point_ = TypedConstruct(info, &Constructor<Point>::Call<int, int>, 0);
-  } else if (info.Length() == 2) {
-    point_ = TypedConstruct(info, &Constructor<Point>::Call<int, int>);
-  } else {
-    Napi::Env env = info.Env();
-    THROW_JS_WRONG_NUMBER_OF_ARGUMENTS(env);
-  }
+  static const auto overloads =
+      Overloads(Overload(&Constructor<Point>::Call<int, int>, 0, 0),
+                Overload(&Constructor<Point>::Call<int, int>, 0),
+                &Constructor<Point>::Call<int, int>);
+  point_ = TypedConstruct(info, overloads);
 }
 
 void PointJs::SetX(const Napi::CallbackInfo& info, const Napi::Value& v) {
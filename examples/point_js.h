@@ -6,6 +6,7 @@
 
 #include <iostream>
 
+#include "node_binding/property_key.h"
 #include "node_binding/type_convertor.h"
 #include "point.h"
 
@@ -22,8 +23,6 @@ class PointJs : public Napi::ObjectWrap<PointJs> {
   Napi::Value GetY(const Napi::CallbackInfo& info);
 
  private:
-  static Napi::FunctionReference constructor_;
-
   Point point_;
 };
 
@@ -33,27 +32,40 @@ template <>
 class TypeConvertor<Point> {
  public:
   static Point ToNativeValue(const Napi::Value& value) {
+    Napi::Env env = value.Env();
     Napi::Object obj = value.As<Napi::Object>();
 
     return {
-        TypeConvertor<int>::ToNativeValue(obj["x"]),
-        TypeConvertor<int>::ToNativeValue(obj["y"]),
+        TypeConvertor<int>::ToNativeValue(obj.Get(X().Value(env))),
+        TypeConvertor<int>::ToNativeValue(obj.Get(Y().Value(env))),
     };
   }
 
   static bool IsConvertible(const Napi::Value& value) {
     if (!value.IsObject()) return false;
 
+    Napi::Env env = value.Env();
     Napi::Object obj = value.As<Napi::Object>();
 
-    return TypeConvertor<int>::IsConvertible(obj["x"]) &&
-           TypeConvertor<int>::IsConvertible(obj["y"]);
+    return TypeConvertor<int>::IsConvertible(obj.Get(X().Value(env))) &&
+           TypeConvertor<int>::IsConvertible(obj.Get(Y().Value(env)));
   }
 
   static Napi::Value ToJSValue(const Napi::Env& env,
                                const Point& value) {
     return PointJs::New(env, value);
   }
+
+ private:
+  static const property_key& X() {
+    static const property_key key("x");
+    return key;
+  }
+
+  static const property_key& Y() {
+    static const property_key key("y");
+    return key;
+  }
 };
 
 }  // namespace node_binding
\ No newline at end of file
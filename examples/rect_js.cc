@@ -5,12 +5,11 @@
 #include "examples/rect_js.h"
 
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
 #include "node_binding/type_convertor.h"
 
 using namespace node_binding;
 
-Napi::FunctionReference RectJs::constructor_;
-
 // static
 void RectJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(
@@ -22,23 +21,17 @@ void RectJs::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("area", &RectJs::Area),
       });
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  SetConstructor<RectJs>(env, func);
 
   exports.Set("Rect", func);
 }
 
 RectJs::RectJs(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<RectJs>(info) {
-  if (info.Length() == 0) {
-    rect_ = TypedConstruct(info, &Constructor<Rect>::Call<>);
-  } else if (info.Length() == 2) {
-    rect_ = TypedConstruct(
-        info, &Constructor<Rect>::Call<const Point&, const Point&>);
-  } else {
-    Napi::Env env = info.Env();
-    THROW_JS_WRONG_NUMBER_OF_ARGUMENTS(env);
-  }
+  static const auto overloads =
+      Overloads(&Constructor<Rect>::Call<>,
+                &Constructor<Rect>::Call<const Point&, const Point&>);
+  rect_ = TypedConstruct(info, overloads);
 }
 
 void RectJs::SetTopLeft(const Napi::CallbackInfo& info, const Napi::Value& v) {
@@ -22,7 +22,5 @@ class RectJs : public Napi::ObjectWrap<RectJs> {
   Napi::Value Area(const Napi::CallbackInfo& info);
 
  private:
-  static Napi::FunctionReference constructor_;
-
   Rect rect_;
 };
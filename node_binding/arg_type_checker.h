@@ -5,37 +5,90 @@
 #ifndef NODE_BINDING_ARG_TYPE_CHECKER_H_
 #define NODE_BINDING_ARG_TYPE_CHECKER_H_
 
-#include <sstream>
+#include <string>
 #include <type_traits>
 
 #include "napi.h"
+#include "node_binding/macros.h"
 #include "node_binding/template_util.h"
 #include "node_binding/type_convertor.h"
 
 namespace node_binding {
 
+/**
+ * @brief Policies of argument validation, which are passed to TypedCall<>()
+ * or NODE_BINDING_BIND_WITH_CHECKS().
+ *
+ * @code
+ * TypedCall<arg_checks::unchecked>(info, &Add);
+ * @endcode
+ */
+namespace arg_checks {
+
+// Checks the number and the types of arguments and throws a TypeError on
+// mismatch. This is the default.
+struct strict {
+  static constexpr bool kEnabled = true;
+};
+
+// Same as strict, but only when NDEBUG is not defined.
+struct debug {
+#ifdef NDEBUG
+  static constexpr bool kEnabled = false;
+#else
+  static constexpr bool kEnabled = true;
+#endif
+};
+
+// Trusts the caller and converts arguments as they are. Use it only for a
+// binding whose caller is known to pass the right arguments; otherwise the
+// result of a conversion is unspecified.
+struct unchecked {
+  static constexpr bool kEnabled = false;
+};
+
+}  // namespace arg_checks
+
+namespace internal {
+
+inline void ThrowArgTypeMismatch(const Napi::Env& env, size_t i) {
+  Napi::TypeError::New(env,
+                       "Type of arg" + std::to_string(i) + " is mismatched")
+      .ThrowAsJavaScriptException();
+}
+
+// Returns false after throwing a TypeError if |info| doesn't have |num_args|
+// arguments and Policy checks them.
+template <typename Policy>
+bool CheckNumArgs(const Napi::CallbackInfo& info, size_t num_args) {
+  if (!Policy::kEnabled || info.Length() == num_args) return true;
+  THROW_JS_WRONG_NUMBER_OF_ARGUMENTS(info.Env());
+  return false;
+}
+
+}  // namespace internal
+
 template <typename... Args>
 struct ArgTypeChecker {
-  static void Check(const Napi::CallbackInfo& info, size_t i, size_t n) {
-    return;
+  static bool Check(const Napi::CallbackInfo& info, size_t i, size_t n) {
+    return true;
   }
 };
 
 template <typename T, typename... Rest>
 struct ArgTypeChecker<T, Rest...> {
-  static void Check(const Napi::CallbackInfo& info, size_t i, size_t n) {
-    if (i == n) return;
+  static bool Check(const Napi::CallbackInfo& info, size_t i, size_t n) {
+    if (i == n) return true;
 
     if (TypeConvertor<std::decay_t<T>>::IsConvertible(info[i])) {
       return ArgTypeChecker<Rest...>::Check(info, i + 1, n);
     } else {
-      std::stringstream ss;
-      ss << "Type of arg" << i << " is mismatched";
-      Napi::TypeError::New(info.Env(), ss.str()).ThrowAsJavaScriptException();
+      internal::ThrowArgTypeMismatch(info.Env(), i);
+      return false;
     }
   }
 };
 
 }  // namespace node_binding
 
-#endif  // NODE_BINDING_ARG_TYPE_CHECKER_H_
\ No newline at end of file
+#endif  // NODE_BINDING_ARG_TYPE_CHECKER_H_
@@ -0,0 +1,390 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_BATCH_H_
+#define NODE_BINDING_BATCH_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/bind.h"
+#include "node_binding/build_config.h"
+#include "node_binding/prepared_callback.h"
+#include "node_binding/string_arena.h"
+#include "node_binding/type_convertor.h"
+#include "node_binding/typed_array.h"
+
+namespace node_binding {
+
+namespace internal {
+
+// A column of arguments which is given as an Array. Each element is
+// converted by TypeConvertor<T>.
+template <typename T, bool = TypedArrayTraits<T>::kSupported>
+class BatchColumn {
+ public:
+  bool Init(const Napi::Value& value) {
+    if (!value.IsArray()) return false;
+    env_ = value.Env();
+    array_ = value;
+    uint32_t length;
+    if (napi_get_array_length(env_, array_, &length) != napi_ok) return false;
+    length_ = length;
+    return true;
+  }
+
+  size_t Length() const { return length_; }
+
+  bool Load(size_t i, T* out) const {
+    napi_value element;
+    if (napi_get_element(env_, array_, static_cast<uint32_t>(i), &element) !=
+        napi_ok)
+      return false;
+    return internal::TryToNativeValue<T>(Napi::Value(env_, element), out);
+  }
+
+ protected:
+  napi_env env_ = nullptr;
+  napi_value array_ = nullptr;
+  size_t length_ = 0;
+};
+
+// A TypedArray of T is read in place; an Array is still accepted.
+template <typename T>
+class BatchColumn<T, true> : public BatchColumn<T, false> {
+ public:
+  bool Init(const Napi::Value& value) {
+    napi_typedarray_type type;
+    void* data;
+    if (GetTypedArrayInfo(value, &type, &this->length_, &data) &&
+        TypedArrayTraits<T>::Matches(type)) {
+      data_ = static_cast<const T*>(data);
+      return true;
+    }
+    data_ = nullptr;
+    return BatchColumn<T, false>::Init(value);
+  }
+
+  bool Load(size_t i, T* out) const {
+    if (!data_) return BatchColumn<T, false>::Load(i, out);
+    *out = data_[i];
+    return true;
+  }
+
+ private:
+  const T* data_ = nullptr;
+};
+
+// The column of results. An arithmetic R is written directly into the
+// backing store of a TypedArray, anything else goes into an Array.
+template <typename R, bool = TypedArrayTraits<R>::kSupported>
+class BatchResult {
+ public:
+  BatchResult(napi_env env, size_t length) : env_(env), array_(nullptr) {
+    if (napi_create_array_with_length(env_, length, &array_) != napi_ok)
+      array_ = nullptr;
+  }
+
+  // Whether the column is allocated. Store() must not be called otherwise.
+  bool ok() const { return array_ != nullptr; }
+
+  template <typename Fn>
+  void Store(size_t i, Fn&& fn) {
+    napi_set_element(env_, array_, static_cast<uint32_t>(i),
+                     ToJSValue(Napi::Env(env_), fn()));
+  }
+
+  Napi::Value Value() const { return Napi::Value(env_, array_); }
+
+ private:
+  napi_env env_;
+  napi_value array_;
+};
+
+template <typename R>
+class BatchResult<R, true> {
+ public:
+  BatchResult(napi_env env, size_t length)
+      : env_(env), arraybuffer_(nullptr), data_(nullptr), length_(length) {
+    void* data;
+    if (napi_create_arraybuffer(env_, length * sizeof(R), &data,
+                                &arraybuffer_) == napi_ok) {
+      data_ = static_cast<R*>(data);
+    } else {
+      arraybuffer_ = nullptr;
+    }
+  }
+
+  // Whether the column is allocated. Store() must not be called otherwise.
+  bool ok() const { return arraybuffer_ != nullptr; }
+
+  template <typename Fn>
+  void Store(size_t i, Fn&& fn) {
+    data_[i] = fn();
+  }
+
+  Napi::Value Value() const {
+    return NewTypedArray<R>(env_, arraybuffer_, length_);
+  }
+
+ private:
+  napi_env env_;
+  napi_value arraybuffer_;
+  R* data_;
+  size_t length_;
+};
+
+template <>
+class BatchResult<void, false> {
+ public:
+  BatchResult(napi_env env, size_t length) : env_(env) {}
+
+  bool ok() const { return true; }
+
+  template <typename Fn>
+  void Store(size_t i, Fn&& fn) {
+    fn();
+  }
+
+  Napi::Value Value() const { return Napi::Env(env_).Undefined(); }
+
+ private:
+  napi_env env_;
+};
+
+inline void ThrowColumnMismatch(const Napi::Env& env, size_t column,
+                                const char* what) {
+  Napi::TypeError::New(env, std::string(what) + " of column" +
+                                std::to_string(column) + " is mismatched")
+      .ThrowAsJavaScriptException();
+}
+
+// The allocation may have thrown already, e.g. a RangeError for a length
+// which is too large.
+inline void ThrowResultNotAllocated(const Napi::Env& env) {
+  if (env.IsExceptionPending()) return;
+  Napi::RangeError::New(env, "Failed to allocate the results")
+      .ThrowAsJavaScriptException();
+}
+
+inline void ThrowRowTypeMismatch(const Napi::Env& env, size_t column,
+                                 size_t row) {
+  Napi::TypeError::New(env, "Type of arg" + std::to_string(column) +
+                                " at row " + std::to_string(row) +
+                                " is mismatched")
+      .ThrowAsJavaScriptException();
+}
+
+template <typename R, typename... Args>
+class Batch {
+  static_assert(sizeof...(Args) > 0,
+                "A batch call needs at least one argument column.");
+  static_assert(
+      AllOf({std::is_default_constructible<std::decay_t<Args>>::value...}),
+      "A batch call needs default constructible arguments.");
+
+  using Columns = std::tuple<BatchColumn<std::decay_t<Args>>...>;
+  using Row = std::tuple<std::decay_t<Args>...>;
+
+ public:
+  // Runs |fn| over every row of the argument columns.
+  template <typename Fn>
+  static Napi::Value Call(const Napi::CallbackInfo& info, Fn&& fn) {
+    return CallImpl(info, fn, std::index_sequence_for<Args...>());
+  }
+
+ private:
+  template <typename Fn, size_t... Is>
+  static Napi::Value CallImpl(const Napi::CallbackInfo& info, Fn& fn,
+                              std::index_sequence<Is...>) {
+    Napi::Env env = info.Env();
+    if (info.Length() != sizeof...(Args)) {
+      THROW_JS_WRONG_NUMBER_OF_ARGUMENTS(env);
+      return env.Undefined();
+    }
+
+    Columns columns;
+    size_t lengths[] = {InitColumn(info, Is, &std::get<Is>(columns))...};
+    for (size_t i = 0; i < sizeof...(Args); ++i) {
+      if (lengths[i] == SIZE_MAX) {
+        ThrowColumnMismatch(env, i, "Type");
+        return env.Undefined();
+      }
+      if (lengths[i] != lengths[0]) {
+        ThrowColumnMismatch(env, i, "Length");
+        return env.Undefined();
+      }
+    }
+
+    size_t length = lengths[0];
+    BatchResult<std::decay_t<R>> result(env, length);
+    if (!result.ok()) {
+      ThrowResultNotAllocated(env);
+      return env.Undefined();
+    }
+    {
+      // Handles of the converted elements are released every so often
+      // rather than per row.
+      callback_scope scope(env);
+      Row row;
+      for (size_t i = 0; i < length; ++i) {
+        scope.Tick();
+        StringArenaScope string_arena_scope;
+        size_t failed = sizeof...(Args);
+        bool loaded = true;
+        (void)std::initializer_list<bool>{
+            (loaded = loaded && LoadCell(std::get<Is>(columns), i, Is,
+                                         &std::get<Is>(row), &failed))...};
+        if (!loaded) {
+          ThrowRowTypeMismatch(env, failed, i);
+          return env.Undefined();
+        }
+        result.Store(i, [&] {
+          return fn(std::forward<Args>(std::get<Is>(row))...);
+        });
+      }
+    }
+    RETURN_UNDEFINED_IF_HAS_PENDING_EXCEPTION(env);
+    return result.Value();
+  }
+
+  // Returns the length of the column, or SIZE_MAX if |info[i]| is not a
+  // column of T.
+  template <typename Column>
+  static size_t InitColumn(const Napi::CallbackInfo& info, size_t i,
+                           Column* column) {
+    return column->Init(info[i]) ? column->Length() : SIZE_MAX;
+  }
+
+  template <typename Column, typename T>
+  static bool LoadCell(const Column& column, size_t row, size_t i, T* out,
+                       size_t* failed) {
+    if (column.Load(row, out)) return true;
+    *failed = i;
+    return false;
+  }
+};
+
+}  // namespace internal
+
+/**
+ * @brief Calls f once per row of argument columns in a single crossing.
+ *
+ * Each argument is given as a column: a TypedArray of the argument type,
+ * which is read in place, or an Array whose elements are converted by
+ * TypeConvertor. All columns have to be of the same length. Results are
+ * returned as a TypedArray if the return type has one, otherwise as an
+ * Array, or undefined for void.
+ *
+ * @code
+ * add(1, 2), add(3, 4) --> addBatch(new Float64Array([1, 3]), [2, 4])
+ * @endcode
+ *
+ * @tparam R
+ * @tparam Args
+ * @param info
+ * @param f
+ * @return Napi::Value
+ */
+template <typename R, typename... Args>
+Napi::Value TypedCallBatch(const Napi::CallbackInfo& info, R (*f)(Args...)) {
+  return internal::Batch<R, Args...>::Call(info, f);
+}
+
+template <typename R, typename... Args>
+Napi::Value TypedCallBatch(const Napi::CallbackInfo& info,
+                           const std::function<R(Args...)>& f) {
+  return internal::Batch<R, Args...>::Call(info, f);
+}
+
+template <typename R, typename Class, typename... Args>
+Napi::Value TypedCallBatch(const Napi::CallbackInfo& info,
+                           R (Class::*f)(Args...), Class* c) {
+  return internal::Batch<R, Args...>::Call(info, [f, c](Args&&... args) {
+    return (c->*f)(std::forward<Args>(args)...);
+  });
+}
+
+template <typename R, typename Class, typename... Args>
+Napi::Value TypedCallBatch(const Napi::CallbackInfo& info,
+                           R (Class::*f)(Args...) const, const Class* c) {
+  return internal::Batch<R, Args...>::Call(info, [f, c](Args&&... args) {
+    return (c->*f)(std::forward<Args>(args)...);
+  });
+}
+
+/**
+ * @brief The batch variant of node_binding::Bound, which calls
+ * TypedCallBatch() with f.
+ *
+ * Use NODE_BINDING_BIND_BATCH() (or BindBatch<f>() for c++17).
+ *
+ * @tparam F
+ * @tparam f
+ */
+template <typename F, F f>
+struct BoundBatch;
+
+template <typename R, typename... Args, R (*f)(Args...)>
+struct BoundBatch<R (*)(Args...), f>
+    : internal::BoundBase<BoundBatch<R (*)(Args...), f>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    return TypedCallBatch(info, f);
+  }
+};
+
+template <typename R, typename Class, typename... Args,
+          R (Class::*f)(Args...)>
+struct BoundBatch<R (Class::*)(Args...), f>
+    : internal::BoundBase<BoundBatch<R (Class::*)(Args...), f>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    Class* c = Napi::ObjectWrap<Class>::Unwrap(info.This().As<Napi::Object>());
+    if (!c) return info.Env().Undefined();
+    return TypedCallBatch(info, f, c);
+  }
+};
+
+template <typename R, typename Class, typename... Args,
+          R (Class::*f)(Args...) const>
+struct BoundBatch<R (Class::*)(Args...) const, f>
+    : internal::BoundBase<BoundBatch<R (Class::*)(Args...) const, f>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    const Class* c =
+        Napi::ObjectWrap<Class>::Unwrap(info.This().As<Napi::Object>());
+    if (!c) return info.Env().Undefined();
+    return TypedCallBatch(info, f, c);
+  }
+};
+
+#if CXX_VER >= 201703
+/**
+ * @brief Returns a napi_callback which calls TypedCallBatch() with f.
+ *
+ * @tparam f a function or a member function of an ObjectWrap.
+ */
+template <auto f>
+constexpr napi_callback BindBatch() {
+  return &BoundBatch<decltype(f), f>::Callback;
+}
+#endif
+
+}  // namespace node_binding
+
+/**
+ * @brief node_binding::BoundBatch<> of a function or a member function.
+ *
+ * @code
+ * exports.Set("addBatch", NODE_BINDING_BIND_BATCH(&Add)::New(env, "addBatch"));
+ * @endcode
+ */
+#define NODE_BINDING_BIND_BATCH(f) ::node_binding::BoundBatch<decltype(f), f>
+
+#endif  // NODE_BINDING_BATCH_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_BIND_H_
+#define NODE_BINDING_BIND_H_
+
+#include "napi.h"
+#include "node_binding/build_config.h"
+#include "node_binding/typed_call.h"
+
+namespace node_binding {
+
+namespace internal {
+
+// Wraps Call() into a napi_callback. A Napi::Error thrown by Call() is
+// turned into a pending JS exception the same way node-addon-api does.
+template <typename BoundT>
+napi_value BoundCallback(napi_env env, napi_callback_info cbinfo) {
+#ifdef NAPI_CPP_EXCEPTIONS
+  try {
+    Napi::CallbackInfo info(env, cbinfo);
+    return BoundT::Call(info);
+  } catch (const Napi::Error& e) {
+    e.ThrowAsJavaScriptException();
+    return nullptr;
+  }
+#else
+  Napi::CallbackInfo info(env, cbinfo);
+  return BoundT::Call(info);
+#endif
+}
+
+template <typename BoundT>
+struct BoundBase {
+  static napi_value Callback(napi_env env, napi_callback_info info) {
+    return BoundCallback<BoundT>(env, info);
+  }
+
+  static Napi::Function New(napi_env env, const char* utf8name = nullptr) {
+    napi_value ret;
+    napi_status status =
+        napi_create_function(env, utf8name, NAPI_AUTO_LENGTH,
+                             &BoundBase::Callback, nullptr, &ret);
+    if (status != napi_ok) return Napi::Function();
+    return Napi::Function(env, ret);
+  }
+
+  // Can be passed to both Napi::Object::DefineProperties() and
+  // Napi::ObjectWrap<T>::DefineClass(). Use napi_static for a static method.
+  static napi_property_descriptor Descriptor(
+      const char* utf8name,
+      napi_property_attributes attributes = napi_default) {
+    return {utf8name, nullptr, &BoundBase::Callback, nullptr,
+            nullptr,  nullptr, attributes,          nullptr};
+  }
+};
+
+}  // namespace internal
+
+/**
+ * @brief Native function which is bound at compile time.
+ *
+ * Unlike TypedCall() with a function pointer or std::function, the callee is
+ * a template argument, so Callback is a plain napi_callback which calls it
+ * directly, and nothing is allocated when it is registered. A member function
+ * is called on the ObjectWrap which is bound to `this`, so Class has to
+ * derive from Napi::ObjectWrap<Class>.
+ *
+ * Use NODE_BINDING_BIND() (or Bind<f>() for c++17) rather than spelling out
+ * the template arguments.
+ *
+ * @tparam F
+ * @tparam f
+ * @tparam Policy one of node_binding::arg_checks
+ */
+template <typename F, F f, typename Policy = arg_checks::strict>
+struct Bound;
+
+template <typename R, typename... Args, R (*f)(Args...), typename Policy>
+struct Bound<R (*)(Args...), f, Policy>
+    : internal::BoundBase<Bound<R (*)(Args...), f, Policy>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    return internal::CallResult<R>::Get(
+        info, [&info] { return TypedCall<Policy>(info, f); });
+  }
+};
+
+template <typename R, typename Class, typename... Args,
+          R (Class::*f)(Args...), typename Policy>
+struct Bound<R (Class::*)(Args...), f, Policy>
+    : internal::BoundBase<Bound<R (Class::*)(Args...), f, Policy>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    Class* c = Napi::ObjectWrap<Class>::Unwrap(info.This().As<Napi::Object>());
+    if (!c) return info.Env().Undefined();
+    return internal::CallResult<R>::Get(
+        info, [&info, c] { return TypedCall<Policy>(info, f, c); });
+  }
+};
+
+template <typename R, typename Class, typename... Args,
+          R (Class::*f)(Args...) const, typename Policy>
+struct Bound<R (Class::*)(Args...) const, f, Policy>
+    : internal::BoundBase<Bound<R (Class::*)(Args...) const, f, Policy>> {
+  static Napi::Value Call(const Napi::CallbackInfo& info) {
+    const Class* c =
+        Napi::ObjectWrap<Class>::Unwrap(info.This().As<Napi::Object>());
+    if (!c) return info.Env().Undefined();
+    return internal::CallResult<R>::Get(
+        info, [&info, c] { return TypedCall<Policy>(info, f, c); });
+  }
+};
+
+#if CXX_VER >= 201703
+/**
+ * @brief Returns a napi_callback which calls f directly.
+ *
+ * @code
+ * napi_value fn;
+ * napi_create_function(env, "add", NAPI_AUTO_LENGTH, node_binding::Bind<&Add>(),
+ *                      nullptr, &fn);
+ * @endcode
+ *
+ * @tparam f a function or a member function of an ObjectWrap.
+ * @tparam Policy one of node_binding::arg_checks
+ */
+template <auto f, typename Policy = arg_checks::strict>
+constexpr napi_callback Bind() {
+  return &Bound<decltype(f), f, Policy>::Callback;
+}
+#endif
+
+}  // namespace node_binding
+
+/**
+ * @brief node_binding::Bound<> of a function or a member function.
+ *
+ * @code
+ * exports.Set("add", NODE_BINDING_BIND(&Add)::New(env, "add"));
+ * @endcode
+ */
+#define NODE_BINDING_BIND(f) ::node_binding::Bound<decltype(f), f>
+
+/**
+ * @brief NODE_BINDING_BIND() with one of node_binding::arg_checks.
+ *
+ * @code
+ * NODE_BINDING_BIND_WITH_CHECKS(&Add, node_binding::arg_checks::debug)
+ * @endcode
+ */
+#define NODE_BINDING_BIND_WITH_CHECKS(f, policy) \
+  ::node_binding::Bound<decltype(f), f, policy>
+
+#endif  // NODE_BINDING_BIND_H_
@@ -0,0 +1,32 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_BUILD_CONFIG_H_
+#define NODE_BINDING_BUILD_CONFIG_H_
+
+#if defined(_MSVC_LANG)
+#define CXX_VER _MSVC_LANG
+#else
+#define CXX_VER __cplusplus
+#endif
+
+#ifdef __cpp_exceptions
+#define CXX_EXCEPTIONS
+#endif
+
+#if defined(__clang__)
+#if __has_feature(cxx_rtti)
+#define CXX_RTTI
+#endif
+#elif defined(__GNUG__)
+#if defined(__GXX_RTTI)
+#define CXX_RTTI
+#endif
+#elif defined(_MSC_VER)
+#if defined(_CPPRTTI)
+#define CXX_RTTI
+#endif
+#endif
+
+#endif  // NODE_BINDING_BUILD_CONFIG_H_
@@ -0,0 +1,127 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_CANCEL_CONTEXT_H_
+#define NODE_BINDING_CANCEL_CONTEXT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace node_binding {
+
+/**
+ * @brief Tells native work of a cancellable promise that it should stop.
+ *
+ * It is canceled by cancel() of the promise or by the AbortSignal which is
+ * given to the call, and expires at its deadline, e.g. the timeout of the
+ * call. A loop polls canceled(), and blocking work waits by sleep_for() or
+ * wait() so that it wakes up as soon as it is canceled.
+ *
+ * @code
+ * while (!ctx->canceled()) {
+ *   if (!ctx->wait([&] { return !jobs.empty(); })) break;
+ *   ...
+ * }
+ * @endcode
+ */
+class cancel_context {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  cancel_context() : canceled_(false), deadline_(kNoDeadline) {}
+
+  cancel_context(const cancel_context&) = delete;
+  cancel_context& operator=(const cancel_context&) = delete;
+
+  // Cheap enough to be polled by a loop; the clock is read only if a
+  // deadline is set.
+  bool canceled() const {
+    if (canceled_.load(std::memory_order_acquire)) return true;
+    clock::rep deadline = deadline_.load(std::memory_order_relaxed);
+    return deadline != kNoDeadline &&
+           clock::now().time_since_epoch().count() >= deadline;
+  }
+
+  void cancel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      canceled_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  clock::time_point deadline() const {
+    clock::rep deadline = deadline_.load(std::memory_order_relaxed);
+    if (deadline == kNoDeadline) return clock::time_point::max();
+    return clock::time_point(clock::duration(deadline));
+  }
+
+  void set_deadline(clock::time_point deadline) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      deadline_ = deadline.time_since_epoch().count();
+    }
+    cv_.notify_all();
+  }
+
+  // Wakes up wait() to check its predicate again.
+  void notify() {
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+  }
+
+  // Sleeps for |duration|. Returns false if it is canceled meanwhile.
+  template <typename Rep, typename Period>
+  bool sleep_for(const std::chrono::duration<Rep, Period>& duration) {
+    WaitUntil(clock::now() + duration, [] { return false; });
+    return !canceled();
+  }
+
+  // Waits until |ready| returns true or it is canceled, and returns the
+  // last result of |ready|. |ready| is called with the lock of the context
+  // held, so whoever changes what it reads has to call notify() after.
+  template <typename Predicate>
+  bool wait(Predicate ready) {
+    return WaitUntil(clock::time_point::max(), ready);
+  }
+
+  template <typename Rep, typename Period, typename Predicate>
+  bool wait_for(const std::chrono::duration<Rep, Period>& timeout,
+                Predicate ready) {
+    return WaitUntil(clock::now() + timeout, ready);
+  }
+
+ private:
+  static constexpr clock::rep kNoDeadline = clock::duration::max().count();
+
+  template <typename Predicate>
+  bool WaitUntil(clock::time_point until, Predicate ready) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      if (ready()) return true;
+      if (canceled() || clock::now() >= until) return false;
+      clock::time_point wake = std::min(until, deadline());
+      if (wake == clock::time_point::max()) {
+        cv_.wait(lock);
+      } else {
+        cv_.wait_until(lock, wake);
+      }
+    }
+  }
+
+  std::atomic_bool canceled_;
+  std::atomic<clock::rep> deadline_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+using cancel_context_ptr = std::shared_ptr<cancel_context>;
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_CANCEL_CONTEXT_H_
@@ -0,0 +1,365 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_CHANNEL_H_
+#define NODE_BINDING_CHANNEL_H_
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/completion_queue.h"
+#include "node_binding/promise.h"
+#include "node_binding/thread_pool.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+namespace internal {
+
+template <typename T>
+class ChannelReader;
+
+}  // namespace internal
+
+/**
+ * @brief A bounded buffer through which a native producer streams items to
+ * JS.
+ *
+ * The producer runs on a worker thread and calls Push() for each item. Push()
+ * blocks while the buffer holds |capacity| items, so a producer never runs
+ * further ahead of the consumer than that. It returns false once the
+ * consumer has stopped, e.g. by break out of a for await loop, and the
+ * producer should return then.
+ *
+ * The thread of the env is woken up only when the consumer waits for an item
+ * and the buffer turns non-empty, and it takes every buffered item without
+ * another wake-up, so items are delivered in batches rather than by a hop
+ * per item.
+ *
+ * @tparam T
+ */
+template <typename T>
+class channel {
+ public:
+  static constexpr size_t kDefaultCapacity = 256;
+
+  explicit channel(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity > 0 ? capacity : 1),
+        closed_(false),
+        failed_(false),
+        stopped_(false),
+        waiting_(false) {}
+
+  channel(const channel&) = delete;
+  channel& operator=(const channel&) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  // Can be called on any thread but the thread of the env.
+  bool Push(T value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_cv_.wait(lock,
+                   [this] { return items_.size() < capacity_ || stopped_; });
+    if (stopped_ || closed_) return false;
+    items_.push_back(std::move(value));
+    WakeLocked();
+    return true;
+  }
+
+  // Ends the stream with an error, which rejects the next read.
+  void Fail(std::string what) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    error_ = std::move(what);
+    failed_ = true;
+    closed_ = true;
+    WakeLocked();
+  }
+
+  // Returns true once the consumer doesn't take items anymore.
+  bool stopped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopped_;
+  }
+
+ private:
+  friend class internal::ChannelReader<T>;
+
+  enum Read { kItem, kEmpty, kDone, kFailed };
+
+  // Called once the producer returns.
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    closed_ = true;
+    WakeLocked();
+  }
+
+  // Called by the consumer on the thread of the env. |wake| is pushed to
+  // |queue| when an item comes after a read which is kEmpty.
+  void Listen(std::shared_ptr<completion_queue> queue,
+              completion_queue::completion wake) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_ = std::move(queue);
+    wake_ = std::move(wake);
+  }
+
+  // Called by the consumer on the thread of the env. Once it returns kEmpty,
+  // the queue of the env is referenced until |wake_| is run.
+  Read TryRead(T* item, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!items_.empty()) {
+      *item = std::move(items_.front());
+      items_.pop_front();
+      // Every pop frees a slot for one of the producers which may wait, not
+      // only the one which leaves the buffer full no more.
+      space_cv_.notify_one();
+      return kItem;
+    }
+    if (failed_) {
+      *error = error_;
+      failed_ = false;
+      return kFailed;
+    }
+    if (closed_ || stopped_) return kDone;
+    if (!waiting_) {
+      waiting_ = true;
+      queue_->Ref();
+    }
+    return kEmpty;
+  }
+
+  // Called by the consumer on the thread of the env.
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+      items_.clear();
+    }
+    space_cv_.notify_all();
+  }
+
+  void WakeLocked() {
+    if (!waiting_) return;
+    waiting_ = false;
+    queue_->Push(wake_);
+  }
+
+  size_t capacity_;
+  bool closed_;
+  bool failed_;
+  bool stopped_;
+  bool waiting_;
+  std::string error_;
+  std::deque<T> items_;
+  std::shared_ptr<completion_queue> queue_;
+  completion_queue::completion wake_;
+  mutable std::mutex mutex_;
+  std::condition_variable space_cv_;
+};
+
+/**
+ * @brief A native producer which is returned to JS as an async iterable.
+ *
+ * The producer starts on a worker thread as soon as the generator is
+ * returned to JS, and streams its items through a channel<T> of |capacity|.
+ * The stream ends when the producer returns, or with an error by
+ * channel::Fail() or by an exception. It runs on |pool|, or on the libuv
+ * threadpool if it is null; a producer which is blocked by a full buffer
+ * holds its thread, so give it a pool of its own if many streams may be
+ * read slowly at a time. The producer runs after the call returns, so the
+ * bound function has to take arguments which own what they hold, e.g.
+ * std::string rather than const char*.
+ *
+ * @code
+ * node_binding::async_generator<std::string> Query(std::string sql) {
+ *   return node_binding::async_generator<std::string>(
+ *       [sql](node_binding::channel<std::string>& rows) {
+ *         for (Cursor cursor(sql); cursor.Next();) {
+ *           if (!rows.Push(cursor.Row())) return;
+ *         }
+ *       });
+ * }
+ * @endcode
+ *
+ * @code
+ * for await (const row of query('SELECT * FROM t')) { ... }
+ * @endcode
+ *
+ * @tparam T
+ */
+template <typename T>
+class async_generator {
+ public:
+  using producer = std::function<void(channel<T>&)>;
+
+  explicit async_generator(producer fn,
+                           size_t capacity = channel<T>::kDefaultCapacity,
+                           std::shared_ptr<thread_pool> pool = nullptr)
+      : fn_(std::move(fn)), capacity_(capacity), pool_(std::move(pool)) {}
+
+ private:
+  friend class TypeConvertor<async_generator<T>>;
+
+  producer fn_;
+  size_t capacity_;
+  std::shared_ptr<thread_pool> pool_;
+};
+
+namespace internal {
+
+// The JS side of a channel. It lives as long as the functions of the
+// iterator, and stops the channel once they are collected.
+template <typename T>
+class ChannelReader : public std::enable_shared_from_this<ChannelReader<T>> {
+ public:
+  explicit ChannelReader(std::shared_ptr<channel<T>> ch)
+      : channel_(std::move(ch)) {}
+
+  ~ChannelReader() { channel_->Stop(); }
+
+  void Listen(Napi::Env env) {
+    std::weak_ptr<ChannelReader> self = this->shared_from_this();
+    channel_->Listen(completion_queue::Get(env), [self](Napi::Env env) {
+      if (std::shared_ptr<ChannelReader> reader = self.lock())
+        reader->Settle(env);
+    });
+  }
+
+  // Runs |fn| on |pool|, or on the libuv threadpool if it is null, and closes
+  // |ch| once it returns.
+  static void StartProducer(Napi::Env env, std::shared_ptr<thread_pool> pool,
+                            std::function<void(channel<T>&)> fn,
+                            std::shared_ptr<channel<T>> ch) {
+    std::function<void()> run = [fn, ch] {
+#ifdef CXX_EXCEPTIONS
+      try {
+#endif
+        fn(*ch);
+        ch->Close();
+#ifdef CXX_EXCEPTIONS
+      } catch (const std::exception& e) {
+        ch->Fail(e.what());
+      }
+#endif
+    };
+    if (pool) {
+      pool->Post(std::move(run));
+      return;
+    }
+    (new async_worker(env))->Queue(std::move(run));
+  }
+
+  Napi::Value Next(Napi::Env env) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    pending_.push_back(deferred);
+    Settle(env);
+    return deferred.Promise();
+  }
+
+  Napi::Value Return(Napi::Env env) {
+    channel_->Stop();
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    pending_.push_back(deferred);
+    Settle(env);
+    return deferred.Promise();
+  }
+
+ private:
+  static Napi::Object Result(Napi::Env env, Napi::Value value, bool done) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("value", value);
+    result.Set("done", done);
+    return result;
+  }
+
+  // Settles the pending reads by the items which are buffered so far.
+  void Settle(Napi::Env env) {
+    while (!pending_.empty()) {
+      T item;
+      std::string error;
+      typename channel<T>::Read read = channel_->TryRead(&item, &error);
+      if (read == channel<T>::kEmpty) return;
+
+      Napi::Promise::Deferred deferred = pending_.front();
+      pending_.pop_front();
+      if (read == channel<T>::kItem) {
+        deferred.Resolve(
+            Result(env, node_binding::ToJSValue(env, std::move(item)), false));
+      } else if (read == channel<T>::kFailed) {
+        RejectWithNativeError(env, deferred, error);
+      } else {
+        deferred.Resolve(Result(env, env.Undefined(), true));
+      }
+    }
+  }
+
+  std::shared_ptr<channel<T>> channel_;
+  std::deque<Napi::Promise::Deferred> pending_;
+};
+
+}  // namespace internal
+
+namespace internal {
+
+template <typename T>
+struct IsDeferredResult<async_generator<T>> : std::true_type {};
+
+}  // namespace internal
+
+/**
+ * @brief node_binding::async_generator<T> --> AsyncIterable
+ *
+ * @code
+ * {next(), return(), [Symbol.asyncIterator]()}
+ * @endcode
+ *
+ * @tparam T
+ */
+template <typename T>
+class TypeConvertor<async_generator<T>> {
+ public:
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const async_generator<T>& value) {
+    std::shared_ptr<channel<T>> ch =
+        std::make_shared<channel<T>>(value.capacity_);
+    std::shared_ptr<internal::ChannelReader<T>> reader =
+        std::make_shared<internal::ChannelReader<T>>(ch);
+    reader->Listen(env);
+
+    Napi::Object iterator = Napi::Object::New(env);
+    iterator.Set("next", Napi::Function::New(
+                             env, [reader](const Napi::CallbackInfo& info) {
+                               return reader->Next(info.Env());
+                             }));
+    iterator.Set("return", Napi::Function::New(
+                               env, [reader](const Napi::CallbackInfo& info) {
+                                 return reader->Return(info.Env());
+                               }));
+    Napi::Value async_iterator = env.Global()
+                                     .Get("Symbol")
+                                     .As<Napi::Object>()
+                                     .Get("asyncIterator");
+    iterator.Set(async_iterator,
+                 Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+                   return info.This();
+                 }));
+
+    internal::ChannelReader<T>::StartProducer(env, value.pool_, value.fn_, ch);
+    return iterator;
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_CHANNEL_H_
@@ -0,0 +1,217 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_COMPLETION_QUEUE_H_
+#define NODE_BINDING_COMPLETION_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/build_config.h"
+#include "node_binding/env_local.h"
+
+namespace node_binding {
+
+/**
+ * @brief Runs completions which are pushed from any thread on the thread of
+ * an env.
+ *
+ * There is one queue per env, which owns a single long-lived thread safe
+ * function. Completions are pushed into a lock-free list, and the thread
+ * safe function is signaled only when the list turns non-empty, so a single
+ * wake-up drains every completion which is ready by then.
+ *
+ * The queue doesn't keep the event loop alive by itself. Call Ref() on the
+ * thread of the env for each completion which is expected; each completion
+ * which is run drops one reference, and Unref() drops one which will never
+ * come, e.g. for canceled work.
+ *
+ * An error which a completion throws, or leaves pending, is reported as an
+ * uncaught exception of the env, and the completions after it still run.
+ *
+ * @code
+ * auto queue = completion_queue::Get(env);
+ * queue->Ref();
+ * // On a worker thread.
+ * queue->Push([deferred](Napi::Env env) { deferred.Resolve(env.Null()); });
+ * @endcode
+ */
+class completion_queue {
+ public:
+  using completion = std::function<void(Napi::Env)>;
+
+  static std::shared_ptr<completion_queue> Get(napi_env env) {
+    return internal::EnvLocal<Holder>::Get(env).queue;
+  }
+
+  ~completion_queue() {
+    Node* node = head_.exchange(nullptr);
+    while (node) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  completion_queue(const completion_queue&) = delete;
+  completion_queue& operator=(const completion_queue&) = delete;
+
+  // Must be called on the thread of the env.
+  void Ref() {
+    if (pending_++ == 0 && tsfn_) napi_ref_threadsafe_function(env_, tsfn_);
+  }
+
+  // Must be called on the thread of the env.
+  void Unref() {
+    if (pending_ == 0) return;
+    if (--pending_ == 0 && tsfn_) napi_unref_threadsafe_function(env_, tsfn_);
+  }
+
+  // Can be called on any thread. Returns false if the env is already torn
+  // down, in which case |c| is never run.
+  bool Push(completion c) {
+    if (closed_.load(std::memory_order_acquire)) return false;
+    Node* node = new Node{std::move(c), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    if (node->next) return true;
+    // Held while the thread safe function is called, so that it isn't
+    // finalized meanwhile.
+    std::lock_guard<std::mutex> lock(tsfn_mutex_);
+    if (!tsfn_) return false;
+    return napi_call_threadsafe_function(tsfn_, nullptr,
+                                         napi_tsfn_nonblocking) == napi_ok;
+  }
+
+ private:
+  struct Node {
+    completion fn;
+    Node* next;
+  };
+
+  // Owns the queue of an env, and closes it when the env is torn down.
+  // Workers may still hold the queue after that.
+  struct Holder {
+    explicit Holder(napi_env env) : queue(new completion_queue(env)) {
+      queue->Open(queue);
+    }
+    ~Holder() { queue->Close(); }
+
+    std::shared_ptr<completion_queue> queue;
+  };
+
+  explicit completion_queue(napi_env env)
+      : env_(env),
+        tsfn_(nullptr),
+        pending_(0),
+        closed_(false),
+        head_(nullptr) {}
+
+  // Creates the thread safe function, which keeps |self| until it is
+  // finalized, so that CallJs() never outlives the queue.
+  void Open(const std::shared_ptr<completion_queue>& self) {
+    napi_value name;
+    napi_create_string_utf8(env_, "node_binding::completion_queue",
+                            NAPI_AUTO_LENGTH, &name);
+    std::shared_ptr<completion_queue>* data =
+        new std::shared_ptr<completion_queue>(self);
+    napi_threadsafe_function tsfn;
+    if (napi_create_threadsafe_function(
+            env_, nullptr, nullptr, name, 0, 1, data,
+            &completion_queue::Finalize, this, &completion_queue::CallJs,
+            &tsfn) != napi_ok) {
+      delete data;
+      closed_ = true;
+      return;
+    }
+    napi_unref_threadsafe_function(env_, tsfn);
+    std::lock_guard<std::mutex> lock(tsfn_mutex_);
+    tsfn_ = tsfn;
+  }
+
+  // Called on the thread of the env when it is torn down. The env may have
+  // finalized the thread safe function already, in which case it does
+  // nothing.
+  void Close() {
+    if (closed_.exchange(true, std::memory_order_acq_rel)) return;
+    // Only Finalize() resets |tsfn_|, on this thread. The thread safe
+    // function is aborted but stays valid until then.
+    if (tsfn_) napi_release_threadsafe_function(tsfn_, napi_tsfn_abort);
+  }
+
+  static void Finalize(napi_env env, void* data, void* hint) {
+    std::unique_ptr<std::shared_ptr<completion_queue>> self(
+        static_cast<std::shared_ptr<completion_queue>*>(data));
+    completion_queue* queue = self->get();
+    queue->closed_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(queue->tsfn_mutex_);
+    queue->tsfn_ = nullptr;
+  }
+
+  static void CallJs(napi_env env, napi_value js_callback, void* context,
+                     void* data) {
+    // |env| is null if the queue is being torn down.
+    if (!env) return;
+    static_cast<completion_queue*>(context)->Drain(Napi::Env(env));
+  }
+
+  // Runs every completion which is pushed so far, in the order of pushes.
+  void Drain(Napi::Env env) {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    Node* reversed = nullptr;
+    while (node) {
+      Node* next = node->next;
+      node->next = reversed;
+      reversed = node;
+      node = next;
+    }
+
+    while (reversed) {
+      Napi::HandleScope scope(env);
+      std::unique_ptr<Node> current(reversed);
+      reversed = reversed->next;
+      Run(env, current->fn);
+      Unref();
+    }
+  }
+
+  // Runs |fn| without letting an error escape the C callback of the thread
+  // safe function.
+  static void Run(Napi::Env env, const completion& fn) {
+#ifdef CXX_EXCEPTIONS
+    try {
+#endif
+      fn(env);
+#ifdef CXX_EXCEPTIONS
+    } catch (const Napi::Error& e) {
+      e.ThrowAsJavaScriptException();
+    } catch (const std::exception& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    } catch (...) {
+      Napi::Error::New(env, "unknown exception").ThrowAsJavaScriptException();
+    }
+#endif
+    if (!env.IsExceptionPending()) return;
+    napi_fatal_exception(env, env.GetAndClearPendingException().Value());
+  }
+
+  napi_env env_;
+  // Written on the thread of the env, and guarded for Push().
+  napi_threadsafe_function tsfn_;
+  std::mutex tsfn_mutex_;
+  size_t pending_;
+  std::atomic_bool closed_;
+  std::atomic<Node*> head_;
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_COMPLETION_QUEUE_H_
@@ -0,0 +1,200 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_CONCURRENCY_LIMIT_H_
+#define NODE_BINDING_CONCURRENCY_LIMIT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "napi.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+// What a concurrency_limit does with a job which can't start right away.
+enum class overflow_policy {
+  // Waits in the queue, and is rejected if the queue is full.
+  kQueue,
+  // Is rejected without waiting.
+  kReject,
+  // Waits in the queue. If the queue is full, the oldest job in it is
+  // rejected to make room.
+  kShedOldest,
+};
+
+/**
+ * @brief Limits how many promise jobs are in flight at a time.
+ *
+ * A limit which is given to one binding is a per-function limit, and one
+ * which is shared by many bindings, or is the |parent| of others, is a
+ * global one. A job holds a slot of its limit and of every parent until it
+ * is done. A job which is rejected is settled with {status: "busy"}.
+ *
+ * It must be used only on the thread of the env.
+ *
+ * @code
+ * auto global = std::make_shared<concurrency_limit>(64);
+ * auto compact = std::make_shared<concurrency_limit>(
+ *     2, 16, overflow_policy::kShedOldest, global);
+ * @endcode
+ */
+class concurrency_limit
+    : public std::enable_shared_from_this<concurrency_limit> {
+ public:
+  explicit concurrency_limit(
+      size_t max_in_flight,
+      size_t max_queued = SIZE_MAX,
+      overflow_policy policy = overflow_policy::kQueue,
+      std::shared_ptr<concurrency_limit> parent = nullptr)
+      : max_in_flight_(max_in_flight > 0 ? max_in_flight : 1),
+        max_queued_(max_queued),
+        policy_(policy),
+        parent_(std::move(parent)),
+        in_flight_(0) {}
+
+  concurrency_limit(const concurrency_limit&) = delete;
+  concurrency_limit& operator=(const concurrency_limit&) = delete;
+
+  size_t in_flight() const { return in_flight_; }
+  size_t queued() const { return queue_.size(); }
+
+  // Calls |start| once the job may run, or |reject| if it may not. A job
+  // which is started has to call Done() when it is done. |canceled| tells
+  // whether a waiting job is canceled, so that Purge() can drop it.
+  void Admit(std::function<void()> start, std::function<void()> reject,
+             std::function<bool()> canceled = nullptr) {
+    if (in_flight_ < max_in_flight_) {
+      Start(std::move(start), std::move(reject), std::move(canceled));
+      return;
+    }
+
+    if (policy_ == overflow_policy::kReject ||
+        (policy_ == overflow_policy::kQueue && queue_.size() >= max_queued_) ||
+        max_queued_ == 0) {
+      reject();
+      return;
+    }
+    if (queue_.size() >= max_queued_) {
+      std::function<void()> shed = std::move(queue_.front().reject);
+      queue_.pop_front();
+      shed();
+    }
+    queue_.push_back(
+        {std::move(start), std::move(reject), std::move(canceled)});
+  }
+
+  // Drops the waiting jobs which are canceled, here and in every parent, so
+  // that they neither take room in the queue nor count as queued. Each of
+  // them is rejected, which frees the slots which it holds.
+  void Purge() {
+    std::vector<std::function<void()>> rejects;
+    for (auto it = queue_.begin(); it != queue_.end();) {
+      if (!it->canceled || !it->canceled()) {
+        ++it;
+        continue;
+      }
+      rejects.push_back(std::move(it->reject));
+      it = queue_.erase(it);
+    }
+    // A rejection may start the next job, which changes the queue.
+    for (std::function<void()>& reject : rejects) reject();
+    if (parent_) parent_->Purge();
+  }
+
+  // Frees the slots of a job which is started.
+  void Done() {
+    if (parent_) parent_->Done();
+    Release();
+  }
+
+ private:
+  struct Pending {
+    std::function<void()> start;
+    std::function<void()> reject;
+    std::function<bool()> canceled;
+  };
+
+  void Start(std::function<void()> start, std::function<void()> reject,
+             std::function<bool()> canceled) {
+    ++in_flight_;
+    if (!parent_) {
+      start();
+      return;
+    }
+    // The slot is held while the job waits for the parent.
+    std::shared_ptr<concurrency_limit> self = shared_from_this();
+    parent_->Admit(
+        std::move(start),
+        [self, reject] {
+          self->Release();
+          reject();
+        },
+        std::move(canceled));
+  }
+
+  void Release() {
+    --in_flight_;
+    if (queue_.empty()) return;
+    Pending next = std::move(queue_.front());
+    queue_.pop_front();
+    Start(std::move(next.start), std::move(next.reject),
+          std::move(next.canceled));
+  }
+
+  size_t max_in_flight_;
+  size_t max_queued_;
+  overflow_policy policy_;
+  std::shared_ptr<concurrency_limit> parent_;
+  size_t in_flight_;
+  std::deque<Pending> queue_;
+};
+
+/**
+ * @brief node_binding::concurrency_limit --> Object
+ *
+ * The object reads the current counts of the limit, so JS can apply
+ * backpressure before it calls a binding.
+ *
+ * @code
+ * {inFlight: number, queued: number}
+ * @endcode
+ */
+template <>
+class TypeConvertor<std::shared_ptr<concurrency_limit>> {
+ public:
+  static Napi::Value ToJSValue(
+      const Napi::Env& env, const std::shared_ptr<concurrency_limit>& value) {
+    Napi::Object object = Napi::Object::New(env);
+    if (!value) return object;
+    std::shared_ptr<concurrency_limit> limit = value;
+    object.DefineProperties({
+        Napi::PropertyDescriptor::Accessor(
+            env, object, "inFlight",
+            [limit](const Napi::CallbackInfo& info) -> Napi::Value {
+              return Napi::Number::New(
+                  info.Env(), static_cast<double>(limit->in_flight()));
+            },
+            napi_enumerable),
+        Napi::PropertyDescriptor::Accessor(
+            env, object, "queued",
+            [limit](const Napi::CallbackInfo& info) -> Napi::Value {
+              return Napi::Number::New(info.Env(),
+                                       static_cast<double>(limit->queued()));
+            },
+            napi_enumerable),
+    });
+    return object;
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_CONCURRENCY_LIMIT_H_
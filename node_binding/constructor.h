@@ -22,17 +22,61 @@ struct Constructor {
   };
 };
 
-template <typename R, typename... Args, typename... DefaultArgs>
+// Constructs by |f| with the arguments of |info|. If they don't match, it
+// returns R() with a pending exception rather than calls |f|.
+template <typename Policy = arg_checks::strict, typename R, typename... Args,
+          typename... DefaultArgs>
 R TypedConstruct(const Napi::CallbackInfo& info, R (*f)(Args...),
                  DefaultArgs&&... def_args) {
   constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs);
-  JS_CHECK_NUM_ARGS(info, num_args);
-  // TODO: How can stop calling constructor if there has a pending exception?
-
-  return internal::Invoke(info, f, std::make_index_sequence<num_args>(),
+  if (!internal::CheckNumArgs<Policy>(info, num_args)) return R();
+  internal::StringArenaScope string_arena_scope;
+  internal::ConvertedArgs<internal::TypeList<Args...>,
+                          std::make_index_sequence<num_args>, Policy>
+      args;
+  if (!args.Convert(info)) return R();
+  return internal::Invoke(info, f, args, std::make_index_sequence<num_args>(),
                           std::forward<DefaultArgs>(def_args)...);
 }
 
+namespace internal {
+
+template <typename Policy, size_t I, typename OverloadsT>
+auto ConstructOverload(const OverloadsT& o, const Napi::CallbackInfo& info) {
+  return o.template get<I>().Apply(
+      [&info](auto f, auto... def_args) {
+        return TypedConstruct<Policy>(info, f, std::move(def_args)...);
+      });
+}
+
+template <typename R, typename Policy, typename OverloadsT, size_t... Is>
+R ConstructOverloads(const OverloadsT& o, std::index_sequence<Is...>,
+                     const Napi::CallbackInfo& info) {
+  using Thunk = R (*)(const OverloadsT&, const Napi::CallbackInfo&);
+  static constexpr Thunk kThunks[] = {
+      &ConstructOverload<Policy, Is, OverloadsT>...};
+
+  int index = o.Select(info);
+  if (index < 0) return R();
+  return kThunks[index](o, info);
+}
+
+}  // namespace internal
+
+/**
+ * @brief Constructs with the overload which matches |info|. Every overload
+ * has to return the same type, and it has to be default constructible to be
+ * returned when no overload takes info.Length() arguments.
+ */
+template <typename Policy = arg_checks::strict, typename Overload,
+          typename... Overloads>
+typename Overload::ReturnType TypedConstruct(
+    const Napi::CallbackInfo& info,
+    const overloads<Overload, Overloads...>& o) {
+  return internal::ConstructOverloads<typename Overload::ReturnType, Policy>(
+      o, std::index_sequence_for<Overload, Overloads...>(), info);
+}
+
 }  // namespace node_binding
 
 #endif  // NODE_BINDING_CONSTRUCTOR_H_
\ No newline at end of file
@@ -0,0 +1,31 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_ENV_LOCAL_H_
+#define NODE_BINDING_ENV_LOCAL_H_
+
+#include "napi.h"
+#include "node_binding/instance_data.h"
+
+namespace node_binding {
+namespace internal {
+
+/**
+ * @brief Holds one T per napi_env, in a slot of node_binding::instance_data.
+ *
+ * T is constructed with the env on first use and destroyed by an env cleanup
+ * hook, so it may release its handles in its destructor.
+ *
+ * @tparam T has to be constructible from napi_env.
+ */
+template <typename T>
+class EnvLocal {
+ public:
+  static T& Get(napi_env env) { return instance_data::Get(env).slot<T>(); }
+};
+
+}  // namespace internal
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_ENV_LOCAL_H_
@@ -0,0 +1,221 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_INSTANCE_DATA_H_
+#define NODE_BINDING_INSTANCE_DATA_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "napi.h"
+
+namespace node_binding {
+
+namespace internal {
+
+inline size_t NextInstanceSlotId() {
+  static std::atomic<size_t> next_id(0);
+  return next_id++;
+}
+
+template <typename T>
+size_t InstanceSlotId() {
+  static const size_t id = NextInstanceSlotId();
+  return id;
+}
+
+}  // namespace internal
+
+/**
+ * @brief The data of the addon in an env.
+ *
+ * Every env which loads the addon, i.e. the main thread and each of
+ * worker_threads, has its own, so the constructors, caches and pools which
+ * are kept in it are never shared by envs and need no lock. It is stored by
+ * napi_set_instance_data, so the addon must not set instance data of its
+ * own; keep it in a slot instead.
+ *
+ * A slot holds one T, which is constructed on first use with the env if T is
+ * constructible from napi_env, or by default otherwise. Slots are destroyed
+ * in the reverse order of their construction by an env cleanup hook, so a
+ * slot may release its handles in its destructor.
+ *
+ * Before N-API 3 there are no env cleanup hooks, so the data of an env is
+ * never destroyed with it: it is kept until its thread exits, and each
+ * worker_thread which loads the addon leaks its own. Envs which come and go
+ * need NAPI_VERSION 3 or later.
+ *
+ * @code
+ * struct Cache {
+ *   explicit Cache(napi_env env);
+ *   ...
+ * };
+ *
+ * Cache& cache = node_binding::instance_data::Get(env).slot<Cache>();
+ * @endcode
+ */
+class instance_data {
+ public:
+  // Must be called on the thread of |env|.
+  static instance_data& Get(napi_env env) {
+#if (NAPI_VERSION > 5)
+    void* data = nullptr;
+    if (napi_get_instance_data(env, &data) == napi_ok && data)
+      return *static_cast<instance_data*>(data);
+
+    instance_data* created = new instance_data(env);
+    napi_set_instance_data(env, created, &instance_data::Finalize, nullptr);
+    napi_add_env_cleanup_hook(env, &instance_data::Cleanup, created);
+    return *created;
+#else
+    Map& map = GetMap();
+    auto it = map.find(env);
+    if (it == map.end()) {
+      it = map.emplace(env, std::unique_ptr<instance_data>(
+                                new instance_data(env)))
+               .first;
+#if (NAPI_VERSION > 2)
+      napi_add_env_cleanup_hook(env, &instance_data::Erase, env);
+#endif
+    }
+    return *it->second;
+#endif
+  }
+
+  ~instance_data() { Clear(); }
+
+  instance_data(const instance_data&) = delete;
+  instance_data& operator=(const instance_data&) = delete;
+
+  napi_env env() const { return env_; }
+
+  template <typename T>
+  T& slot() {
+    size_t id = internal::InstanceSlotId<T>();
+    if (id >= slots_.size() || !slots_[id]) {
+      // T may use other slots while it is constructed.
+      std::unique_ptr<Slot<T>> slot(
+          new Slot<T>(id, env_, std::is_constructible<T, napi_env>()));
+      if (id >= slots_.size()) slots_.resize(id + 1, nullptr);
+      slots_[id] = slot.get();
+      order_.push_back(std::move(slot));
+    }
+    return static_cast<Slot<T>*>(slots_[id])->value;
+  }
+
+ private:
+  struct SlotBase {
+    explicit SlotBase(size_t id) : id(id) {}
+    virtual ~SlotBase() {}
+
+    size_t id;
+  };
+
+  template <typename T>
+  struct Slot : SlotBase {
+    Slot(size_t id, napi_env env, std::true_type) : SlotBase(id), value(env) {}
+    Slot(size_t id, napi_env env, std::false_type) : SlotBase(id), value() {}
+
+    T value;
+  };
+
+  explicit instance_data(napi_env env) : env_(env) {}
+
+  void Clear() {
+    while (!order_.empty()) {
+      std::unique_ptr<SlotBase> slot = std::move(order_.back());
+      order_.pop_back();
+      slots_[slot->id] = nullptr;
+    }
+  }
+
+#if (NAPI_VERSION > 5)
+  static void Cleanup(void* arg) { static_cast<instance_data*>(arg)->Clear(); }
+
+  static void Finalize(napi_env env, void* data, void* hint) {
+    napi_remove_env_cleanup_hook(env, &instance_data::Cleanup, data);
+    delete static_cast<instance_data*>(data);
+  }
+#else
+  using Map = std::unordered_map<napi_env, std::unique_ptr<instance_data>>;
+
+  // An env is only ever used on the thread which runs it, so the table is
+  // thread local and needs no lock.
+  static Map& GetMap() {
+    thread_local Map map;
+    return map;
+  }
+
+  // Without a cleanup hook, before N-API 3, an entry is never erased.
+  static void Erase(void* arg) { GetMap().erase(static_cast<napi_env>(arg)); }
+#endif
+
+  napi_env env_;
+  // Indexed by the id of the type of a slot.
+  std::vector<SlotBase*> slots_;
+  // Owns the slots in the order of their construction.
+  std::vector<std::unique_ptr<SlotBase>> order_;
+};
+
+namespace internal {
+
+template <typename Class>
+struct ConstructorSlot {
+  Napi::FunctionReference constructor;
+};
+
+template <typename Class>
+Napi::FunctionReference& ConstructorOf(napi_env env) {
+  return instance_data::Get(env).slot<ConstructorSlot<Class>>().constructor;
+}
+
+}  // namespace internal
+
+/**
+ * @brief Keeps |constructor| of a wrapped class in the current env.
+ *
+ * It replaces a static Napi::FunctionReference, which is shared by every env
+ * and so is overwritten by an env which loads the addon later.
+ *
+ * @code
+ * void PointJs::Init(Napi::Env env, Napi::Object exports) {
+ *   Napi::Function func = DefineClass(env, "Point", {...});
+ *   node_binding::SetConstructor<PointJs>(env, func);
+ *   exports.Set("Point", func);
+ * }
+ * @endcode
+ *
+ * @tparam Class
+ */
+template <typename Class>
+void SetConstructor(napi_env env, const Napi::Function& constructor) {
+  internal::ConstructorOf<Class>(env) = Napi::Persistent(constructor);
+}
+
+// Returns the constructor of a wrapped class in |env|, which is empty unless
+// it is set by SetConstructor().
+template <typename Class>
+Napi::Function GetConstructor(napi_env env) {
+  Napi::FunctionReference& constructor = internal::ConstructorOf<Class>(env);
+  if (constructor.IsEmpty()) return Napi::Function();
+  return constructor.Value();
+}
+
+// Creates an instance of a wrapped class in |env| by its constructor.
+template <typename Class>
+Napi::Object NewInstance(napi_env env,
+                         const std::initializer_list<napi_value>& args) {
+  return internal::ConstructorOf<Class>(env).New(args);
+}
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_INSTANCE_DATA_H_
@@ -0,0 +1,293 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_JOB_SCHEDULER_H_
+#define NODE_BINDING_JOB_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "napi.h"
+#include "node_binding/thread_pool.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+enum class job_priority { kHigh = 0, kNormal = 1, kLow = 2 };
+
+/**
+ * @brief How a job is scheduled by node_binding::job_scheduler.
+ *
+ * A job is due by |deadline| after it is queued, or by the budget of its
+ * |priority| if no deadline is given.
+ */
+struct schedule_options {
+  job_priority priority = job_priority::kNormal;
+  std::chrono::milliseconds deadline = std::chrono::milliseconds::max();
+};
+
+/**
+ * @brief Runs jobs in the order of their deadlines rather than in the order
+ * they are queued.
+ *
+ * At most |max_running| jobs run at a time, on |pool| or on the libuv
+ * threadpool if it is null. The other jobs wait in a queue which is ordered
+ * by deadline. A job without a deadline is due by the budget of its priority
+ * class, so a low priority job waits behind newer high priority ones only
+ * until its own budget runs out and is never starved.
+ *
+ * The time which jobs wait in the queue is recorded per priority class.
+ *
+ * @code
+ * auto scheduler = std::make_shared<job_scheduler>();
+ * scheduler->Post(env, [] { Compact(); }, {job_priority::kLow});
+ * @endcode
+ */
+class job_scheduler : public std::enable_shared_from_this<job_scheduler> {
+ public:
+  using job = std::function<void()>;
+  using clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultMaxRunning = 4;
+
+  struct wait_stats {
+    uint64_t jobs = 0;
+    clock::duration total_wait = clock::duration::zero();
+    clock::duration max_wait = clock::duration::zero();
+  };
+
+  explicit job_scheduler(std::shared_ptr<thread_pool> pool = nullptr,
+                         size_t max_running = kDefaultMaxRunning)
+      : pool_(std::move(pool)),
+        max_running_(max_running > 0 ? max_running : 1),
+        running_(0),
+        sequence_(0),
+        budgets_{std::chrono::milliseconds(0), std::chrono::milliseconds(20),
+                 std::chrono::milliseconds(200)} {}
+
+  job_scheduler(const job_scheduler&) = delete;
+  job_scheduler& operator=(const job_scheduler&) = delete;
+
+  // Sets how long a job of |priority| without a deadline may wait before it
+  // is due.
+  void SetBudget(job_priority priority, std::chrono::milliseconds budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budgets_[Index(priority)] = budget;
+  }
+
+  wait_stats Stats(job_priority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_[Index(priority)];
+  }
+
+  // Must be called on the thread of |env| unless the scheduler has a pool.
+  void Post(napi_env env, job j,
+            const schedule_options& options = schedule_options()) {
+    bool start_runner = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      clock::time_point now = clock::now();
+      std::chrono::milliseconds delay =
+          options.deadline != std::chrono::milliseconds::max()
+              ? options.deadline
+              : budgets_[Index(options.priority)];
+      queue_.push_back({Due(now, delay), sequence_++, options.priority, now,
+                        std::move(j)});
+      std::push_heap(queue_.begin(), queue_.end(), Later);
+      if (running_ < max_running_) {
+        ++running_;
+        start_runner = true;
+      }
+    }
+    if (start_runner) StartRunner(env);
+  }
+
+ private:
+  struct Entry {
+    clock::time_point due;
+    uint64_t sequence;
+    job_priority priority;
+    clock::time_point queued;
+    job fn;
+  };
+
+  static size_t Index(job_priority priority) {
+    return static_cast<size_t>(priority);
+  }
+
+  // Saturates rather than overflows for a deadline which is too far away to
+  // be a time_point, e.g. 1e15 milliseconds.
+  static clock::time_point Due(clock::time_point now,
+                               std::chrono::milliseconds delay) {
+    if (delay <= std::chrono::milliseconds::zero()) return now;
+    if (delay >= std::chrono::duration_cast<std::chrono::milliseconds>(
+                     clock::time_point::max() - now)) {
+      return clock::time_point::max();
+    }
+    return now + delay;
+  }
+
+  // The heap keeps the earliest due entry at the front. Entries which are
+  // due at the same time run in the order they are queued.
+  static bool Later(const Entry& a, const Entry& b) {
+    if (a.due != b.due) return a.due > b.due;
+    return a.sequence > b.sequence;
+  }
+
+  // A runner which holds a thread of the libuv threadpool.
+  struct Runner {
+    std::shared_ptr<job_scheduler> scheduler;
+    napi_async_work work;
+  };
+
+  void StartRunner(napi_env env) {
+    std::shared_ptr<job_scheduler> self = shared_from_this();
+    if (pool_) {
+      pool_->Post([self] { self->Run(); });
+      return;
+    }
+
+    napi_value name;
+    napi_create_string_utf8(env, "node_binding::job_scheduler",
+                            NAPI_AUTO_LENGTH, &name);
+    Runner* runner = new Runner{self, nullptr};
+    if (napi_create_async_work(env, nullptr, name, &job_scheduler::Execute,
+                               &job_scheduler::Complete, runner,
+                               &runner->work) != napi_ok) {
+      delete runner;
+      // Runs the jobs on this thread rather than leave them queued.
+      Run();
+      return;
+    }
+    if (napi_queue_async_work(env, runner->work) != napi_ok) {
+      napi_delete_async_work(env, runner->work);
+      delete runner;
+      Run();
+    }
+  }
+
+  static void Execute(napi_env env, void* data) {
+    static_cast<Runner*>(data)->scheduler->Run();
+  }
+
+  static void Complete(napi_env env, napi_status status, void* data) {
+    Runner* runner = static_cast<Runner*>(data);
+    napi_delete_async_work(env, runner->work);
+    delete runner;
+  }
+
+  // Runs queued jobs in the order of their deadlines until none is left.
+  void Run() {
+    for (;;) {
+      Entry entry;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+          --running_;
+          return;
+        }
+        std::pop_heap(queue_.begin(), queue_.end(), Later);
+        entry = std::move(queue_.back());
+        queue_.pop_back();
+
+        wait_stats& stats = stats_[Index(entry.priority)];
+        clock::duration wait = clock::now() - entry.queued;
+        ++stats.jobs;
+        stats.total_wait += wait;
+        stats.max_wait = std::max(stats.max_wait, wait);
+      }
+      entry.fn();
+    }
+  }
+
+  std::shared_ptr<thread_pool> pool_;
+  size_t max_running_;
+  size_t running_;
+  uint64_t sequence_;
+  std::chrono::milliseconds budgets_[3];
+  wait_stats stats_[3];
+  std::vector<Entry> queue_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief node_binding::schedule_options <-> Object
+ *
+ * @code
+ * {priority: 'high' | 'normal' | 'low', deadline: milliseconds}
+ * @endcode
+ *
+ * Any other priority doesn't convert, so a call which is given one throws a
+ * TypeError. A deadline which is not finite is ignored.
+ */
+template <>
+class TypeConvertor<schedule_options> {
+ public:
+  static schedule_options ToNativeValue(const Napi::Value& value) {
+    Napi::Object object = value.As<Napi::Object>();
+    schedule_options options;
+    Napi::Value priority = object.Get("priority");
+    if (priority.IsString()) ParsePriority(priority, &options.priority);
+    Napi::Value deadline = object.Get("deadline");
+    if (deadline.IsNumber()) {
+      double ms = deadline.As<Napi::Number>().DoubleValue();
+      // milliseconds::max() means no deadline, so it is kept for that.
+      const double kMaxDeadline = static_cast<double>(
+          std::chrono::milliseconds::max().count() / 2);
+      if (std::isfinite(ms)) {
+        options.deadline = std::chrono::milliseconds(
+            static_cast<int64_t>(std::min(std::max(ms, 0.0), kMaxDeadline)));
+      }
+    }
+    return options;
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    if (!value.IsObject()) return false;
+    Napi::Value priority = value.As<Napi::Object>().Get("priority");
+    if (priority.IsUndefined()) return true;
+    job_priority parsed;
+    return priority.IsString() && ParsePriority(priority, &parsed);
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const schedule_options& value) {
+    static const char* const kNames[] = {"high", "normal", "low"};
+    Napi::Object object = Napi::Object::New(env);
+    object.Set("priority", kNames[static_cast<size_t>(value.priority)]);
+    if (value.deadline != std::chrono::milliseconds::max()) {
+      object.Set("deadline", static_cast<double>(value.deadline.count()));
+    }
+    return object;
+  }
+
+ private:
+  static bool ParsePriority(const Napi::Value& value, job_priority* priority) {
+    std::string name = value.As<Napi::String>().Utf8Value();
+    if (name == "high") {
+      *priority = job_priority::kHigh;
+    } else if (name == "normal") {
+      *priority = job_priority::kNormal;
+    } else if (name == "low") {
+      *priority = job_priority::kLow;
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_JOB_SCHEDULER_H_
@@ -30,20 +30,45 @@
   if (env.IsExceptionPending()) return env.Null()
 #endif
 
-#define RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS()                      \
-  ::Napi::Env env = info.Env();                                         \
-  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs); \
-  JS_CHECK_NUM_ARGS(info, num_args);                                    \
-  RETURN_UNDEFINED_IF_HAS_PENDING_EXCEPTION(env);                       \
-  ::node_binding::ArgTypeChecker<Args...>::Check(info, 0, num_args);    \
-  RETURN_UNDEFINED_IF_HAS_PENDING_EXCEPTION(env)
-
-#define RETURN_IF_FAILED_TO_CHECK_ARGS()                                \
-  ::Napi::Env env = info.Env();                                         \
-  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs); \
-  JS_CHECK_NUM_ARGS(info, num_args);                                    \
-  RETURN_IF_HAS_PENDING_EXCEPTION(env);                                 \
-  ::node_binding::ArgTypeChecker<Args...>::Check(info, 0, num_args);    \
-  RETURN_IF_HAS_PENDING_EXCEPTION(env)
+// Both expect |info|, |Args|, |DefaultArgs| and the argument checking
+// |Policy| in the enclosing scope.
+#define RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS()                           \
+  ::Napi::Env env = info.Env();                                              \
+  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs);      \
+  if (Policy::kEnabled &&                                                    \
+      (!::node_binding::internal::CheckNumArgs<Policy>(info, num_args) ||    \
+       !::node_binding::ArgTypeChecker<Args...>::Check(info, 0, num_args)))  \
+  return env.Undefined()
+
+#define RETURN_IF_FAILED_TO_CHECK_ARGS()                                     \
+  ::Napi::Env env = info.Env();                                              \
+  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs);      \
+  if (Policy::kEnabled &&                                                    \
+      (!::node_binding::internal::CheckNumArgs<Policy>(info, num_args) ||    \
+       !::node_binding::ArgTypeChecker<Args...>::Check(info, 0, num_args)))  \
+  return
+
+#define RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS()                         \
+  ::Napi::Env env = info.Env();                                              \
+  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs);      \
+  if (!::node_binding::internal::CheckNumArgs<Policy>(info, num_args))       \
+    return env.Undefined();                                                  \
+  ::node_binding::internal::StringArenaScope string_arena_scope;             \
+  ::node_binding::internal::ConvertedArgs<                                   \
+      ::node_binding::internal::TypeList<Args...>,                           \
+      std::make_index_sequence<num_args>, Policy>                            \
+      args;                                                                  \
+  if (!args.Convert(info)) return env.Undefined()
+
+#define RETURN_IF_FAILED_TO_CONVERT_ARGS()                                   \
+  constexpr size_t num_args = sizeof...(Args) - sizeof...(DefaultArgs);      \
+  if (!::node_binding::internal::CheckNumArgs<Policy>(info, num_args))       \
+    return;                                                                  \
+  ::node_binding::internal::StringArenaScope string_arena_scope;             \
+  ::node_binding::internal::ConvertedArgs<                                   \
+      ::node_binding::internal::TypeList<Args...>,                           \
+      std::make_index_sequence<num_args>, Policy>                            \
+      args;                                                                  \
+  if (!args.Convert(info)) return
 
 #endif  // NODE_BINDING_MACROS_H_
\ No newline at end of file
@@ -0,0 +1,181 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_PREPARED_CALLBACK_H_
+#define NODE_BINDING_PREPARED_CALLBACK_H_
+
+#include <stddef.h>
+
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+/**
+ * @brief A HandleScope which is shared by many calls to a prepared_callback.
+ *
+ * Opening and closing a HandleScope on every call is a noticeable part of a
+ * short callback. Instead, the scope is recycled once every
+ * |calls_per_scope| calls, so handles which are created by a call are kept
+ * until then and released all at once.
+ */
+class callback_scope {
+ public:
+  static constexpr size_t kDefaultCallsPerScope = 256;
+
+  explicit callback_scope(napi_env env,
+                          size_t calls_per_scope = kDefaultCallsPerScope)
+      : env_(env),
+        scope_(nullptr),
+        calls_(0),
+        calls_per_scope_(calls_per_scope > 0 ? calls_per_scope : 1) {
+    napi_open_handle_scope(env_, &scope_);
+  }
+
+  ~callback_scope() {
+    if (scope_) napi_close_handle_scope(env_, scope_);
+  }
+
+  callback_scope(const callback_scope&) = delete;
+  callback_scope& operator=(const callback_scope&) = delete;
+
+  // Called before each call. Handles of the previous calls are released
+  // when the scope is full.
+  void Tick() {
+    if (++calls_ < calls_per_scope_) return;
+    calls_ = 0;
+    napi_close_handle_scope(env_, scope_);
+    scope_ = nullptr;
+    napi_open_handle_scope(env_, &scope_);
+  }
+
+ private:
+  napi_env env_;
+  napi_handle_scope scope_;
+  size_t calls_;
+  size_t calls_per_scope_;
+};
+
+namespace internal {
+
+template <typename R>
+struct CallbackResult {
+  static R From(napi_env env, napi_status status, napi_value result) {
+    if (status != napi_ok) return R();
+    Napi::Value ret(env, result);
+    if (ret.IsUndefined()) return R();
+    return TypeConvertor<R>::ToNativeValue(ret);
+  }
+};
+
+template <>
+struct CallbackResult<void> {
+  static void From(napi_env env, napi_status status, napi_value result) {}
+};
+
+}  // namespace internal
+
+template <typename Signature>
+class prepared_callback;
+
+/**
+ * @brief A JS function which is called from native code over and over.
+ *
+ * The function and the receiver are held by persistent references, so it
+ * can be kept across calls on the thread which runs the env. The arguments
+ * are converted into an array on the stack, so a call allocates nothing but
+ * the handles of the arguments and the result. Those are released when the
+ * call returns, or by the callback_scope when one is given.
+ *
+ * A JS exception leaves the env with a pending exception and R() is
+ * returned. Since a result is converted before its handle is released, R
+ * should be a native type.
+ *
+ * @tparam R
+ * @tparam Args
+ */
+template <typename R, typename... Args>
+class prepared_callback<R(Args...)> {
+ public:
+  prepared_callback() : env_(nullptr) {}
+
+  explicit prepared_callback(const Napi::Function& fn)
+      : prepared_callback(fn, Napi::Value()) {}
+
+  prepared_callback(const Napi::Function& fn, const Napi::Value& receiver)
+      : env_(fn.Env()), fn_(Napi::Persistent(fn)) {
+    if (!receiver.IsEmpty() && (receiver.IsObject() || receiver.IsFunction()))
+      receiver_ = Napi::Persistent(receiver.As<Napi::Object>());
+  }
+
+  prepared_callback(prepared_callback&&) = default;
+  prepared_callback& operator=(prepared_callback&&) = default;
+
+  bool IsEmpty() const { return fn_.IsEmpty(); }
+
+  Napi::Env Env() const { return Napi::Env(env_); }
+
+  Napi::Function Value() const { return fn_.Value(); }
+
+  R operator()(Args... args) const {
+    Napi::HandleScope scope(env_);
+    return Call(args...);
+  }
+
+  R operator()(callback_scope& scope, Args... args) const {
+    scope.Tick();
+    return Call(args...);
+  }
+
+ private:
+  static constexpr size_t kArgc = sizeof...(Args);
+
+  R Call(const Args&... args) const {
+    napi_value argv[kArgc > 0 ? kArgc : 1] = {
+        ToJSValue(Napi::Env(env_), args)...};
+    napi_value recv;
+    if (receiver_.IsEmpty()) {
+      napi_get_undefined(env_, &recv);
+    } else {
+      recv = receiver_.Value();
+    }
+    napi_value result = nullptr;
+    napi_status status =
+        napi_call_function(env_, recv, fn_.Value(), kArgc, argv, &result);
+    return internal::CallbackResult<R>::From(env_, status, result);
+  }
+
+  napi_env env_;
+  Napi::FunctionReference fn_;
+  Napi::ObjectReference receiver_;
+};
+
+/**
+ * @brief node_binding::prepared_callback<R(Args...)> <-- Function
+ *
+ * @tparam R
+ * @tparam Args
+ */
+template <typename R, typename... Args>
+class TypeConvertor<prepared_callback<R(Args...)>> {
+ public:
+  static prepared_callback<R(Args...)> ToNativeValue(const Napi::Value& value) {
+    return prepared_callback<R(Args...)>(value.As<Napi::Function>());
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    return value.IsFunction();
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const prepared_callback<R(Args...)>& value) {
+    return value.Value();
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_PREPARED_CALLBACK_H_
@@ -5,15 +5,62 @@
 #ifndef NODE_BINDING_PROMISE_H_
 #define NODE_BINDING_PROMISE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <initializer_list>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "node_binding/cancel_context.h"
+#include "node_binding/completion_queue.h"
+#include "node_binding/concurrency_limit.h"
+#include "node_binding/job_scheduler.h"
 #include "node_binding/stl.h"
+#include "node_binding/thread_pool.h"
 #include "node_binding/type_convertor.h"
 #include "node_binding/typed_call.h"
 
 namespace node_binding {
 
+/**
+ * @brief Where the work of ToPromise() and ToCancellablePromise() runs.
+ *
+ * By default it runs on the libuv threadpool. Given a thread_pool, it runs
+ * there instead. Given a job_scheduler, it is scheduled by |options|, which
+ * a call may override by an extra last argument. Given a concurrency_limit,
+ * it starts only once the limit admits it.
+ *
+ * @code
+ * ToPromise(env, Compact, {scheduler, {job_priority::kLow}});
+ * compact(path, {priority: 'high'});
+ * @endcode
+ */
+struct promise_executor {
+  promise_executor() {}
+  promise_executor(std::nullptr_t) {}
+  promise_executor(std::shared_ptr<thread_pool> pool)
+      : pool(std::move(pool)) {}
+  promise_executor(std::shared_ptr<job_scheduler> scheduler,
+                   schedule_options options = schedule_options())
+      : scheduler(std::move(scheduler)), options(options) {}
+  promise_executor(std::shared_ptr<concurrency_limit> limit,
+                   std::shared_ptr<thread_pool> pool = nullptr)
+      : pool(std::move(pool)), limit(std::move(limit)) {}
+
+  std::shared_ptr<thread_pool> pool;
+  std::shared_ptr<job_scheduler> scheduler;
+  schedule_options options;
+  std::shared_ptr<concurrency_limit> limit;
+};
+
 namespace internal {
 
 /**
@@ -51,155 +98,653 @@ class async_worker : public Napi::AsyncWorker {
   std::function<void()> onDestory_;
 };
 
-}  // namespace internal
+inline void RejectWithNativeError(Napi::Env env,
+                                  const Napi::Promise::Deferred& deferred,
+                                  const std::string& what) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("status", Napi::String::New(env, "error"));
+  obj.Set("native", true);
+  obj.Set("result", Napi::String::New(env, what));
+  deferred.Reject(obj);
+}
+
+inline void RejectAsCanceled(Napi::Env env,
+                             const Napi::Promise::Deferred& deferred) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("status", Napi::String::New(env, "canceled"));
+  deferred.Reject(obj);
+}
+
+inline void RejectAsBusy(Napi::Env env,
+                         const Napi::Promise::Deferred& deferred) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("status", Napi::String::New(env, "busy"));
+  deferred.Reject(obj);
+}
 
 /**
- * @brief
- *
- * @tparam Args
- * @param env
- * @param f
- * @return Napi::Value
+ * @brief The work of a promise, which runs on the libuv threadpool or on the
+ * executor which is given, once the concurrency limit of the executor admits
+ * it.
  */
+class PromiseWork : public std::enable_shared_from_this<PromiseWork> {
+ public:
+  PromiseWork(Napi::Env env, promise_executor executor,
+              std::shared_ptr<completion_queue> queue,
+              Napi::Promise::Deferred deferred)
+      : env_(env),
+        executor_(std::move(executor)),
+        queue_(std::move(queue)),
+        deferred_(deferred),
+        wk_(nullptr),
+        wk_destroyed_(std::make_shared<std::atomic_bool>(false)),
+        state_(kIdle),
+        has_deadline_(false),
+        released_(false) {}
+
+  // Keeps |object| alive until Release(), e.g. the wrapper of the object which
+  // the work runs on. Must be called on the thread of the env.
+  void Pin(const Napi::Object& object) { pin_ = Napi::Persistent(object); }
+
+  // Removes |listener| from the abort event of |signal| on Release(), so a
+  // long-lived signal doesn't keep every call which it is given. Must be
+  // called on the thread of the env.
+  void ListenAbort(const Napi::Object& signal, const Napi::Function& listener) {
+    if (released_) {
+      RemoveAbortListener(signal, listener);
+      return;
+    }
+    abort_signal_ = Napi::Persistent(signal);
+    abort_listener_ = Napi::Persistent(listener);
+  }
+
+  // Drops what is kept for the promise: the pin and the abort listener. Must
+  // be called on the thread of the env once the promise is settled.
+  void Release() {
+    released_ = true;
+    pin_.Reset();
+    if (abort_signal_.IsEmpty()) return;
+    RemoveAbortListener(abort_signal_.Value(), abort_listener_.Value());
+    abort_signal_.Reset();
+    abort_listener_.Reset();
+  }
+
+  // Must be called before Queue(). The work is canceled if it doesn't start
+  // by |deadline|.
+  void SetDeadline(cancel_context::clock::time_point deadline) {
+    deadline_ = deadline;
+    has_deadline_ = true;
+  }
+
+  // Must be called on the thread of the env, after the completion queue is
+  // referenced for the promise.
+  void Queue(const schedule_options& options, std::function<void()> execute) {
+    if (has_deadline_) {
+      std::shared_ptr<PromiseWork> self = shared_from_this();
+      std::function<void()> run = std::move(execute);
+      execute = [self, run] {
+        if (cancel_context::clock::now() < self->deadline_) {
+          run();
+          return;
+        }
+        self->queue_->Push([self](Napi::Env env) {
+          self->Release();
+          RejectAsCanceled(env, self->deferred_);
+        });
+      };
+    }
+
+    if (!executor_.limit) {
+      Dispatch(options, std::move(execute));
+      return;
+    }
+
+    state_ = kWaiting;
+    std::shared_ptr<PromiseWork> self = shared_from_this();
+    executor_.limit->Admit(
+        [self, options, execute] {
+          int expected = kWaiting;
+          if (!self->state_.compare_exchange_strong(expected, kIdle)) {
+            // Canceled while it waited.
+            self->executor_.limit->Done();
+            return;
+          }
+          // The slot is freed on the thread of the env once |execute| is
+          // done.
+          self->queue_->Ref();
+          self->Dispatch(options, [self, execute] {
+            execute();
+            self->queue_->Push(
+                [self](Napi::Env env) { self->executor_.limit->Done(); });
+          });
+        },
+        [self] {
+          int expected = kWaiting;
+          if (!self->state_.compare_exchange_strong(expected, kRejected))
+            return;
+          self->queue_->Unref();
+          self->Release();
+          RejectAsBusy(self->env_, self->deferred_);
+        },
+        [self] { return self->state_.load() == kCanceled; });
+  }
+
+  // Must be called on the thread of the env. Returns true if the work is
+  // canceled before it starts, so it never runs.
+  bool Cancel() {
+    int expected = kWaiting;
+    if (state_.compare_exchange_strong(expected, kCanceled)) {
+      Release();
+      executor_.limit->Purge();
+      return true;
+    }
+    if (!CancelDispatched()) return false;
+    if (executor_.limit) {
+      queue_->Unref();
+      executor_.limit->Done();
+    }
+    Release();
+    return true;
+  }
+
+ private:
+  enum State { kIdle, kWaiting, kQueued, kRunning, kCanceled, kRejected };
+
+  static void RemoveAbortListener(const Napi::Object& signal,
+                                  const Napi::Function& listener) {
+    Napi::Value remove = signal.Get("removeEventListener");
+    if (!remove.IsFunction()) return;
+    remove.As<Napi::Function>().Call(
+        signal, {Napi::String::New(signal.Env(), "abort"), listener});
+  }
+
+  void Dispatch(const schedule_options& options,
+                std::function<void()> execute) {
+    if (!executor_.pool && !executor_.scheduler) {
+      std::shared_ptr<std::atomic_bool> wk_destroyed = wk_destroyed_;
+      wk_ = new async_worker(env_);
+      wk_->Queue(std::move(execute),
+                 [wk_destroyed]() mutable { *wk_destroyed = true; });
+      return;
+    }
+
+    state_ = kQueued;
+    std::shared_ptr<PromiseWork> self = shared_from_this();
+    std::function<void()> task = [self, execute] {
+      int expected = kQueued;
+      if (self->state_.compare_exchange_strong(expected, kRunning)) execute();
+    };
+    if (executor_.scheduler) {
+      executor_.scheduler->Post(env_, std::move(task), options);
+    } else {
+      executor_.pool->Post(std::move(task));
+    }
+  }
+
+  bool CancelDispatched() {
+    if (executor_.pool || executor_.scheduler) {
+      int expected = kQueued;
+      return state_.compare_exchange_strong(expected, kCanceled);
+    }
+
+    if (!wk_ || *wk_destroyed_) return false;
+#ifdef CXX_EXCEPTIONS
+    try {
+#endif
+      wk_->Cancel();
+#ifdef NAPI_DISABLE_CPP_EXCEPTIONS
+      if (env_.IsExceptionPending()) {
+        env_.GetAndClearPendingException();
+        return false;
+      }
+#endif
+      return true;
+#ifdef CXX_EXCEPTIONS
+    } catch (Napi::Error&) {
+      return false;
+    }
+#endif
+  }
+
+  Napi::Env env_;
+  promise_executor executor_;
+  std::shared_ptr<completion_queue> queue_;
+  Napi::Promise::Deferred deferred_;
+  async_worker* wk_;
+  std::shared_ptr<std::atomic_bool> wk_destroyed_;
+  std::atomic<int> state_;
+  bool has_deadline_;
+  cancel_context::clock::time_point deadline_;
+  Napi::ObjectReference pin_;
+  // Touched only on the thread of the env.
+  bool released_;
+  Napi::ObjectReference abort_signal_;
+  Napi::FunctionReference abort_listener_;
+};
+
+// Calls |start| with the options which are given as the last argument of
+// the call, if the binding accepts one, or with those of the binding. A
+// cancellable binding always accepts one, for its signal and timeout.
+template <typename... Args, typename Start>
+void StartWork(const Napi::CallbackInfo& info,
+               const promise_executor& executor, bool cancellable,
+               Start&& start) {
+  std::function<void(Args..., schedule_options)> fn(
+      std::forward<Start>(start));
+  if ((cancellable || executor.scheduler) &&
+      info.Length() == sizeof...(Args) + 1) {
+    node_binding::TypedCall(info, fn);
+  } else {
+    node_binding::TypedCall(info, fn, executor.options);
+  }
+}
+
+// The arguments which a job keeps. What they borrow for the synchronous
+// call, e.g. a const char* in the StringArena, is copied.
 template <typename... Args>
-static Napi::Value ToPromise(const Napi::Env& env, void (*f)(Args...)) {
+using OwnedArgs = std::tuple<typename OwnedArg<std::decay_t<Args>>::type...>;
+
+template <typename... Args>
+OwnedArgs<Args...> OwnArgs(Args&... args) {
+  return OwnedArgs<Args...>(
+      OwnedArg<std::decay_t<Args>>::Own(std::move(args))...);
+}
+
+template <typename... Args, typename Fn, size_t... Indices>
+decltype(auto) ApplyOwnedArgs(Fn&& fn, OwnedArgs<Args...>& args,
+                              std::index_sequence<Indices...>) {
+  return fn(OwnedArg<std::decay_t<Args>>::Borrow(std::get<Indices>(args))...);
+}
+
+// Calls |fn| with |args| as Args.
+template <typename... Args, typename Fn>
+decltype(auto) ApplyOwnedArgs(Fn&& fn, OwnedArgs<Args...>& args) {
+  return ApplyOwnedArgs<Args...>(std::forward<Fn>(fn), args,
+                                 std::index_sequence_for<Args...>());
+}
+
+// Returns the options object which follows the |num_args| arguments of the
+// call, or an empty one.
+inline Napi::Object TrailingOptions(const Napi::CallbackInfo& info,
+                                    size_t num_args) {
+  if (info.Length() != num_args + 1 || !info[num_args].IsObject())
+    return Napi::Object();
+  return info[num_args].As<Napi::Object>();
+}
+
+// Applies {timeout: milliseconds} of |options| to |work| and |ctx|.
+inline void SetTimeout(const Napi::Object& options, PromiseWork* work,
+                       cancel_context* ctx) {
+  if (options.IsEmpty()) return;
+  Napi::Value timeout = options.Get("timeout");
+  if (!timeout.IsNumber()) return;
+  cancel_context::clock::time_point deadline =
+      cancel_context::clock::now() +
+      std::chrono::milliseconds(
+          std::max<int64_t>(timeout.As<Napi::Number>().Int64Value(), 0));
+  work->SetDeadline(deadline);
+  if (ctx) ctx->set_deadline(deadline);
+}
+
+// Calls |cancel| once |signal|, an AbortSignal, is aborted. The listener is
+// removed by |work| once its promise is settled.
+inline void CancelOnAbort(const Napi::Value& signal,
+                          const Napi::Function& cancel, PromiseWork* work) {
+  if (!signal.IsObject()) return;
+  Napi::Env env = signal.Env();
+  Napi::Object object = signal.As<Napi::Object>();
+  if (object.Get("aborted").ToBoolean()) {
+    cancel.Call(std::initializer_list<napi_value>{});
+    return;
+  }
+  Napi::Value add_event_listener = object.Get("addEventListener");
+  if (!add_event_listener.IsFunction()) return;
+  Napi::String type = Napi::String::New(env, "abort");
+  Napi::Object listener_options = Napi::Object::New(env);
+  listener_options.Set("once", true);
+  add_event_listener.As<Napi::Function>().Call(
+      object, {type, cancel, listener_options});
+  work->ListenAbort(object, cancel);
+}
+
+// Can be called on any thread. The promise is settled by the completion
+// queue of its env, which has to be referenced for it beforehand.
+inline void PushNativeError(const std::shared_ptr<completion_queue>& queue,
+                            const Napi::Promise::Deferred& deferred,
+                            std::string what) {
+  queue->Push([deferred, what](Napi::Env env) {
+    RejectWithNativeError(env, deferred, what);
+  });
+}
+
+// Like PushNativeError(), and releases |work| once the promise is settled.
+inline void PushReleasingError(const std::shared_ptr<completion_queue>& queue,
+                               const std::shared_ptr<PromiseWork>& work,
+                               const Napi::Promise::Deferred& deferred,
+                               std::string what) {
+  queue->Push([work, deferred, what](Napi::Env env) {
+    work->Release();
+    RejectWithNativeError(env, deferred, what);
+  });
+}
+
+// Returns {promise, cancel} of |work|, which is also canceled by
+// {signal: AbortSignal} of |options|.
+inline Napi::Object NewCancellable(
+    Napi::Env env, const Napi::Promise::Deferred& deferred,
+    const std::shared_ptr<completion_queue>& queue,
+    const std::shared_ptr<PromiseWork>& work, const cancel_context_ptr& ctx,
+    const Napi::Object& options) {
+  Napi::Function cancel = Napi::Function::New(
+      env, [queue, deferred, work, ctx](const Napi::CallbackInfo& info) {
+        if (ctx) ctx->cancel();
+        if (!work->Cancel()) return;
+        // The work never runs, so its completion never comes.
+        queue->Unref();
+        RejectAsCanceled(info.Env(), deferred);
+      });
+  Napi::Object object = Napi::Object::New(env);
+  object.Set("promise", deferred.Promise());
+  object.Set("cancel", cancel);
+  if (!options.IsEmpty()) {
+    CancelOnAbort(options.Get("signal"), cancel, work.get());
+  }
+  return object;
+}
+
+// Calls |fn| and returns the completion which settles |deferred| by its
+// result. If |ctx| is canceled meanwhile, |deferred| is rejected as canceled
+// with the result instead.
+template <typename R>
+struct AsyncResult {
+  template <typename Fn>
+  static completion_queue::completion Run(
+      Fn&& fn, const Napi::Promise::Deferred& deferred,
+      const cancel_context* ctx = nullptr) {
+    R ret = fn();
+    if (ctx && ctx->canceled()) {
+      return [ret, deferred](Napi::Env env) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("status", Napi::String::New(env, "canceled"));
+        obj.Set("native", true);
+        obj.Set("result", node_binding::ToJSValue(env, ret));
+        deferred.Reject(obj);
+      };
+    }
+    return [ret, deferred](Napi::Env env) {
+      deferred.Resolve(node_binding::ToJSValue(env, ret));
+    };
+  }
+};
+
+template <>
+struct AsyncResult<void> {
+  template <typename Fn>
+  static completion_queue::completion Run(
+      Fn&& fn, const Napi::Promise::Deferred& deferred,
+      const cancel_context* ctx = nullptr) {
+    fn();
+    if (ctx && ctx->canceled()) {
+      return [deferred](Napi::Env env) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("status", Napi::String::New(env, "canceled"));
+        obj.Set("native", true);
+        deferred.Reject(obj);
+      };
+    }
+    return [deferred](Napi::Env env) { deferred.Resolve(env.Undefined()); };
+  }
+};
+
+// Calls |call| with the arguments of |info| on the executor, and returns a
+// promise of its result. The object of |info| is pinned until the promise
+// is settled.
+template <typename R, typename... Args, typename Call>
+Napi::Value StartMethodWork(const Napi::CallbackInfo& info,
+                            const promise_executor& executor, Call call) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  std::shared_ptr<completion_queue> queue = completion_queue::Get(env);
+  std::shared_ptr<PromiseWork> work =
+      std::make_shared<PromiseWork>(env, executor, queue, deferred);
+  Napi::Object self = info.This().As<Napi::Object>();
+  StartWork<Args...>(
+      info, executor, /*cancellable=*/false,
+      [work, queue, deferred, self, call](Args... args,
+                                          schedule_options options) {
+        queue->Ref();
+        work->Pin(self);
+#ifdef CXX_EXCEPTIONS
+        try {
+#endif
+          work->Queue(options, [work, queue, deferred, call,
+                                owned = OwnArgs<Args...>(args...)]() mutable {
+#ifdef CXX_EXCEPTIONS
+            try {
+#endif
+              completion_queue::completion done = AsyncResult<R>::Run(
+                  [&]() -> R {
+                    return ApplyOwnedArgs<Args...>(
+                        [&](auto&&... args) -> R { return call(args...); },
+                        owned);
+                  },
+                  deferred);
+              queue->Push([work, done](Napi::Env env) {
+                work->Release();
+                done(env);
+              });
+#ifdef CXX_EXCEPTIONS
+            } catch (const std::exception& e) {
+              std::string what = e.what();
+              queue->Push([work, deferred, what](Napi::Env env) {
+                work->Release();
+                RejectWithNativeError(env, deferred, what);
+              });
+            }
+#endif
+          });
+#ifdef CXX_EXCEPTIONS
+        } catch (const std::exception& e) {
+          work->Release();
+          PushNativeError(queue, deferred, e.what());
+        }
+#endif
+      });
+  return deferred.Promise();
+}
+
+// A callable which is shared by the JS function and its jobs rather than
+// copied into each of them. It may be move-only.
+template <typename F>
+class SharedCallable {
+ public:
+  explicit SharedCallable(F f) : f_(std::make_shared<F>(std::move(f))) {}
+
+  template <typename... Args>
+  decltype(auto) operator()(Args&&... args) const {
+    return (*f_)(std::forward<Args>(args)...);
+  }
+
+ private:
+  std::shared_ptr<F> f_;
+};
+
+template <bool kWithContext>
+struct ContextCall {
+  template <typename Fn, typename... Args>
+  static decltype(auto) Call(Fn& f, const cancel_context_ptr& ctx,
+                             Args&... args) {
+    return f(ctx, args...);
+  }
+};
+
+template <>
+struct ContextCall<false> {
+  template <typename Fn, typename... Args>
+  static decltype(auto) Call(Fn& f, const cancel_context_ptr& ctx,
+                             Args&... args) {
+    return f(args...);
+  }
+};
+
+// Returns the function of ToPromise(), which calls |f| as R(Args...).
+template <typename R, typename... Args, typename Fn>
+Napi::Value NewPromiseFunction(const Napi::Env& env, Fn f,
+                               promise_executor executor) {
   return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
+      env, [f, executor](const Napi::CallbackInfo& info) -> Napi::Value {
         Napi::Env env = info.Env();
         Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([tsfn, deferred,
-                                                f](Args... args) mutable {
+        std::shared_ptr<completion_queue> queue = completion_queue::Get(env);
+        std::shared_ptr<PromiseWork> work =
+            std::make_shared<PromiseWork>(env, executor, queue, deferred);
+        StartWork<Args...>(
+            info, executor, /*cancellable=*/false,
+            [work, queue, deferred, f](Args... args, schedule_options options) {
+              queue->Ref();
 #ifdef CXX_EXCEPTIONS
               try {
 #endif
-                new internal::async_worker(
-                    deferred.Env(), [tsfn, deferred, f, args...]() mutable {
+                work->Queue(options, [queue, deferred, f,
+                                      owned = OwnArgs<Args...>(
+                                          args...)]() mutable {
 #ifdef CXX_EXCEPTIONS
-                      try {
+                  try {
 #endif
-                        f(args...);
-                        tsfn.BlockingCall(
-                            [deferred](Napi::Env env, Napi::Function) {
-                              deferred.Resolve(env.Undefined());
-                            });
+                    queue->Push(AsyncResult<R>::Run(
+                        [&]() -> R {
+                          return ApplyOwnedArgs<Args...>(
+                              [&](auto&&... args) -> R { return f(args...); },
+                              owned);
+                        },
+                        deferred));
 #ifdef CXX_EXCEPTIONS
-                      } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
-                      }
+                  } catch (const std::exception& e) {
+                    PushNativeError(queue, deferred, e.what());
+                  }
 #endif
-                      tsfn.Release();
-                    });
+                });
 #ifdef CXX_EXCEPTIONS
               } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
+                PushNativeError(queue, deferred, e.what());
               }
 #endif
-            }));
+            });
         return deferred.Promise();
       });
 }
 
-/**
- * @brief
- *
- * @tparam R
- * @tparam Args
- * @param env
- * @param f
- * @return Napi::Value
- */
-template <typename R, typename... Args>
-static Napi::Value ToPromise(const Napi::Env& env, R (*f)(Args...)) {
+// Returns the function of ToCancellablePromise(), which calls |f| as
+// R(cancel_context_ptr, Args...) if |kWithContext|, or as R(Args...).
+template <bool kWithContext, typename R, typename... Args, typename Fn>
+Napi::Value NewCancellablePromiseFunction(const Napi::Env& env, Fn f,
+                                          promise_executor executor) {
   return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
+      env, [f, executor](const Napi::CallbackInfo& info) -> Napi::Value {
         Napi::Env env = info.Env();
         Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([deferred, tsfn,
-                                                f](Args... args) mutable {
+        std::shared_ptr<completion_queue> queue = completion_queue::Get(env);
+        std::shared_ptr<PromiseWork> work =
+            std::make_shared<PromiseWork>(env, executor, queue, deferred);
+        cancel_context_ptr ctx;
+        if (kWithContext) ctx = std::make_shared<cancel_context>();
+        Napi::Object options = TrailingOptions(info, sizeof...(Args));
+        SetTimeout(options, work.get(), ctx.get());
+        StartWork<Args...>(
+            info, executor, /*cancellable=*/true,
+            [work, ctx, deferred, queue, f](Args... args,
+                                            schedule_options options) {
+              queue->Ref();
 #ifdef CXX_EXCEPTIONS
               try {
 #endif
-                new internal::async_worker(
-                    deferred.Env(), [deferred, tsfn, f, args...]() mutable {
+                work->Queue(
+                    options, [work, ctx, deferred, queue, f,
+                              owned = OwnArgs<Args...>(args...)]() mutable {
 #ifdef CXX_EXCEPTIONS
                       try {
 #endif
-                        R ret = f(args...);
-                        tsfn.BlockingCall([ret, deferred](Napi::Env env,
-                                                          Napi::Function) {
-                          deferred.Resolve(node_binding::ToJSValue(env, ret));
+                        completion_queue::completion done =
+                            AsyncResult<R>::Run(
+                                [&]() -> R {
+                                  return ApplyOwnedArgs<Args...>(
+                                      [&](auto&&... args) -> R {
+                                        return ContextCall<kWithContext>::Call(
+                                            f, ctx, args...);
+                                      },
+                                      owned);
+                                },
+                                deferred, ctx.get());
+                        queue->Push([work, done](Napi::Env env) {
+                          work->Release();
+                          done(env);
                         });
 #ifdef CXX_EXCEPTIONS
                       } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
+                        PushReleasingError(queue, work, deferred, e.what());
                       }
 #endif
-                      tsfn.Release();
                     });
 #ifdef CXX_EXCEPTIONS
               } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
+                PushReleasingError(queue, work, deferred, e.what());
               }
 #endif
-            }));
-
-        return deferred.Promise();
+            });
+        return NewCancellable(env, deferred, queue, work, ctx, options);
       });
 }
 
-class cancel_context {
- public:
-  cancel_context() : canceled_(false) {}
+// Picks the function of a callable by its signature.
+template <typename R, typename ArgList>
+struct PromiseFunctionFactory;
 
-  bool canceled() { return canceled_; }
-  void cancel() { canceled_ = true; }
+template <typename R, typename... Args>
+struct PromiseFunctionFactory<R, TypeList<Args...>> {
+  template <typename Fn>
+  static Napi::Value New(const Napi::Env& env, Fn f,
+                         promise_executor executor) {
+    return NewPromiseFunction<R, Args...>(env, std::move(f),
+                                          std::move(executor));
+  }
 
- private:
-  std::atomic_bool canceled_;
+  template <typename Fn>
+  static Napi::Value NewCancellable(const Napi::Env& env, Fn f,
+                                    promise_executor executor) {
+    return NewCancellablePromiseFunction<false, R, Args...>(
+        env, std::move(f), std::move(executor));
+  }
 };
 
+template <typename R, typename... Args>
+struct PromiseFunctionFactory<R, TypeList<cancel_context_ptr, Args...>> {
+  template <typename Fn>
+  static Napi::Value New(const Napi::Env& env, Fn f,
+                         promise_executor executor) {
+    return NewPromiseFunction<R, cancel_context_ptr, Args...>(
+        env, std::move(f), std::move(executor));
+  }
+
+  template <typename Fn>
+  static Napi::Value NewCancellable(const Napi::Env& env, Fn f,
+                                    promise_executor executor) {
+    return NewCancellablePromiseFunction<true, R, Args...>(
+        env, std::move(f), std::move(executor));
+  }
+};
+
+template <typename F>
+using CallableTraits = FunctionTraits<decltype(&F::operator())>;
+
+template <typename F>
+using EnableIfCallable =
+    std::enable_if_t<std::is_class<std::decay_t<F>>::value>;
+
+}  // namespace internal
+
 /**
- * @brief
+ * @brief Returns a function which calls |f| on a worker thread, and returns
+ * a Promise of its result.
  *
  * @tparam R
  * @tparam Args
@@ -208,198 +753,45 @@ class cancel_context {
  * @return Napi::Value
  */
 template <typename R, typename... Args>
-static Napi::Value ToCancellablePromise(const Napi::Env& env, R (*f)(Args...)) {
-  return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
-        Napi::Env env = info.Env();
-        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        internal::async_worker* wk = new internal::async_worker(env);
-        std::shared_ptr<std::atomic_bool> wk_destroyed =
-            std::make_shared<std::atomic_bool>(false);
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([wk_destroyed, wk, deferred,
-                                                tsfn, f](Args... args) mutable {
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Queue(
-                    [deferred, tsfn, f, args...]() mutable {
-#ifdef CXX_EXCEPTIONS
-                      try {
-#endif
-                        R ret = f(args...);
-                        tsfn.BlockingCall([ret, deferred](Napi::Env env,
-                                                          Napi::Function) {
-                          deferred.Resolve(node_binding::ToJSValue(env, ret));
-                        });
-#ifdef CXX_EXCEPTIONS
-                      } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
-                      }
-#endif
-                      tsfn.Release();
-                    },
-                    [wk_destroyed]() mutable { *wk_destroyed = true; });
-#ifdef CXX_EXCEPTIONS
-              } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
-              }
-#endif
-            }));
-        Napi::Object object = Napi::Object::New(env);
-        object.Set("promise", deferred.Promise());
-        object.Set(
-            "cancel",
-            Napi::Function::New(env, [wk_destroyed, tsfn, deferred,
-                                      wk](const Napi::CallbackInfo&) mutable {
-              if (*wk_destroyed)
-                return;
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Cancel();
-                Napi::Env env = deferred.Env();
-#ifdef NAPI_DISABLE_CPP_EXCEPTIONS
-                if (env.IsExceptionPending()) {
-                  env.GetAndClearPendingException();
-                  return;
-                }
-#endif
-                tsfn.Release();
-                Napi::Object obj = Napi::Object::New(env);
-                obj.Set("status", Napi::String::New(env, "canceled"));
-                deferred.Reject(obj);
-#ifdef CXX_EXCEPTIONS
-              } catch (Napi::Error&) {
-              }
-#endif              
-            }));
-        return object;
-      });
+static Napi::Value ToPromise(const Napi::Env& env, R (*f)(Args...),
+                             promise_executor executor = promise_executor()) {
+  return internal::NewPromiseFunction<R, Args...>(env, f, std::move(executor));
 }
 
 /**
- * @brief
+ * @brief Same as above, for a lambda, a std::function or any other callable
+ * with a single operator().
  *
- * @tparam Args
+ * The callable is moved into the function once, and shared by its calls
+ * rather than copied into each of them, so it can hold a model or a pool of
+ * connections instead of a global. It may be move-only. It is called on
+ * worker threads, possibly at the same time.
+ *
+ * @code
+ * exports.Set("predict", ToPromise(env, [model = LoadModel()](int x) {
+ *   return model->Predict(x);
+ * }));
+ * @endcode
+ *
+ * @tparam F
  * @param env
  * @param f
  * @return Napi::Value
  */
-template <typename... Args>
-static Napi::Value ToCancellablePromise(const Napi::Env& env,
-                                        void (*f)(Args...)) {
-  return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
-        Napi::Env env = info.Env();
-        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        internal::async_worker* wk = new internal::async_worker(env);
-        std::shared_ptr<std::atomic_bool> wk_destroyed =
-            std::make_shared<std::atomic_bool>(false);
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([wk_destroyed, wk, deferred,
-                                                tsfn, f](Args... args) mutable {
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Queue(
-                    [wk_destroyed, deferred, tsfn, f, args...]() mutable {
-#ifdef CXX_EXCEPTIONS
-                      try {
-#endif
-                        f(args...);
-                        tsfn.BlockingCall(
-                            [deferred](Napi::Env env, Napi::Function) {
-                              deferred.Resolve(env.Undefined());
-                            });
-#ifdef CXX_EXCEPTIONS
-                      } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
-                      }
-#endif
-                      tsfn.Release();
-                    },
-                    [wk_destroyed]() mutable { *wk_destroyed = true; });
-#ifdef CXX_EXCEPTIONS
-              } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
-              }
-#endif
-            }));
-        Napi::Object object = Napi::Object::New(env);
-        object.Set("promise", deferred.Promise());
-        object.Set(
-            "cancel",
-            Napi::Function::New(env, [wk_destroyed, tsfn, deferred,
-                                      wk](const Napi::CallbackInfo&) mutable {
-              if (*wk_destroyed)
-                return;
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Cancel();
-                Napi::Env env = deferred.Env();
-#ifdef NAPI_DISABLE_CPP_EXCEPTIONS
-                if (env.IsExceptionPending()) {
-                  env.GetAndClearPendingException();
-                  return;
-                }
-#endif
-                tsfn.Release();
-                Napi::Object obj = Napi::Object::New(env);
-                obj.Set("status", Napi::String::New(env, "canceled"));
-                deferred.Reject(obj);
-#ifdef CXX_EXCEPTIONS
-              } catch (Napi::Error&) {
-              }
-#endif
-            }));
-        return object;
-      });
+template <typename F, typename = internal::EnableIfCallable<F>>
+static Napi::Value ToPromise(const Napi::Env& env, F&& f,
+                             promise_executor executor = promise_executor()) {
+  using Callable = std::decay_t<F>;
+  using Traits = internal::CallableTraits<Callable>;
+  return internal::PromiseFunctionFactory<
+      typename Traits::ReturnType, typename Traits::ArgList>::
+      New(env, internal::SharedCallable<Callable>(std::forward<F>(f)),
+          std::move(executor));
 }
 
-using cancel_context_ptr = std::shared_ptr<cancel_context>;
-
 /**
- * @brief
+ * @brief Returns a function which calls |f| on a worker thread, and returns
+ * {promise, cancel}.
  *
  * @tparam R
  * @tparam Args
@@ -407,217 +799,87 @@ using cancel_context_ptr = std::shared_ptr<cancel_context>;
  * @param f
  * @return Napi::Value
  */
+template <typename R, typename... Args>
+static Napi::Value ToCancellablePromise(
+    const Napi::Env& env, R (*f)(Args...),
+    promise_executor executor = promise_executor()) {
+  return internal::NewCancellablePromiseFunction<false, R, Args...>(
+      env, f, std::move(executor));
+}
 
+/**
+ * @brief Same as above, for a function which is told by |ctx| that it is
+ * canceled.
+ *
+ * @tparam R
+ * @tparam Args
+ * @param env
+ * @param f
+ * @return Napi::Value
+ */
 template <typename R, typename... Args>
-static Napi::Value ToCancellablePromise(const Napi::Env& env,
-                                        R (*f)(cancel_context_ptr, Args...)) {
-  return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
-        Napi::Env env = info.Env();
-        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        internal::async_worker* wk = new internal::async_worker(env);
-        std::shared_ptr<std::atomic_bool> wk_destroyed =
-            std::make_shared<std::atomic_bool>(false);
-        cancel_context_ptr ctx = std::make_shared<cancel_context>();
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([wk_destroyed, ctx, wk, deferred,
-                                                tsfn, f](Args... args) mutable {
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Queue(
-                    [ctx, deferred, tsfn, f, args...]() mutable {
-#ifdef CXX_EXCEPTIONS
-                      try {
-#endif
-                        R ret = f(ctx, args...);
-                        if (ctx->canceled()) {
-                          tsfn.BlockingCall(
-                              [ret, deferred](Napi::Env env, Napi::Function) {
-                                Napi::Object obj = Napi::Object::New(env);
-                                obj.Set("status",
-                                        Napi::String::New(env, "canceled"));
-                                obj.Set("native", true);
-                                obj.Set("result",
-                                        node_binding::ToJSValue(env, ret));
-                                deferred.Reject(obj);
-                              });
-                        } else {
-                          tsfn.BlockingCall([ret, deferred](Napi::Env env,
-                                                            Napi::Function) {
-                            deferred.Resolve(node_binding::ToJSValue(env, ret));
-                          });
-                        }
-#ifdef CXX_EXCEPTIONS
-                      } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
-                      }
-#endif
-                      tsfn.Release();
-                    },
-                    [wk_destroyed]() mutable { *wk_destroyed = true; });
-#ifdef CXX_EXCEPTIONS
-              } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
-              }
-#endif
-            }));
-        Napi::Object object = Napi::Object::New(env);
-        object.Set("promise", deferred.Promise());
-        object.Set(
-            "cancel",
-            Napi::Function::New(env, [wk_destroyed, tsfn, ctx, deferred,
-                                      wk](const Napi::CallbackInfo&) mutable {
-              ctx->cancel();
-              if (*wk_destroyed)
-                return;
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Cancel();
-                Napi::Env env = deferred.Env();
-#ifdef NAPI_DISABLE_CPP_EXCEPTIONS
-                if (env.IsExceptionPending()) {
-                  env.GetAndClearPendingException();
-                  return;
-                }
-#endif
-                tsfn.Release();
-                Napi::Object obj = Napi::Object::New(env);
-                obj.Set("status", Napi::String::New(env, "canceled"));
-                deferred.Reject(obj);
-#ifdef CXX_EXCEPTIONS
-              } catch (Napi::Error&) {
-              }
-#endif
-            }));
-        return object;
-      });
+static Napi::Value ToCancellablePromise(
+    const Napi::Env& env, R (*f)(cancel_context_ptr, Args...),
+    promise_executor executor = promise_executor()) {
+  return internal::NewCancellablePromiseFunction<true, R, Args...>(
+      env, f, std::move(executor));
 }
 
-template <typename... Args>
-static Napi::Value ToCancellablePromise(const Napi::Env& env,
-                                        void (*f)(cancel_context_ptr,
-                                                  Args...)) {
-  return Napi::Function::New(
-      env, [f](const Napi::CallbackInfo& info) -> Napi::Value {
-        Napi::Env env = info.Env();
-        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-            env, Napi::Function(), "ToPromise resource", 0, 1);
-        internal::async_worker* wk = new internal::async_worker(env);
-        std::shared_ptr<std::atomic_bool> wk_destroyed =
-            std::make_shared<std::atomic_bool>(false);
-        cancel_context_ptr ctx = std::make_shared<cancel_context>();
-        node_binding::TypedCall(
-            info, std::function<void(Args...)>([wk_destroyed, ctx, wk, deferred,
-                                                tsfn, f](Args... args) mutable {
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Queue(
-                    [wk_destroyed, ctx, deferred, tsfn, f, args...]() mutable {
-#ifdef CXX_EXCEPTIONS
-                      try {
-#endif
-                        f(ctx, args...);
-                        if (ctx->canceled()) {
-                          tsfn.BlockingCall(
-                              [deferred](Napi::Env env, Napi::Function) {
-                                Napi::Object obj = Napi::Object::New(env);
-                                obj.Set("status",
-                                        Napi::String::New(env, "canceled"));
-                                obj.Set("native", true);
-                                deferred.Reject(obj);
-                              });
-                        } else {
-                          tsfn.BlockingCall(
-                              [deferred](Napi::Env env, Napi::Function) {
-                                deferred.Resolve(env.Undefined());
-                              });
-                        }
-#ifdef CXX_EXCEPTIONS
-                      } catch (const std::exception& e) {
-                        std::string info = e.what();
-                        tsfn.BlockingCall([info, deferred](Napi::Env env,
-                                                           Napi::Function) {
-                          Napi::Object obj = Napi::Object::New(env);
-                          obj.Set("status", Napi::String::New(env, "error"));
-                          obj.Set("native", true);
-                          obj.Set("result", Napi::String::New(env, info));
-                          deferred.Reject(obj);
-                        });
-                      }
-#endif
-                      tsfn.Release();
-                    },
-                    [wk_destroyed]() mutable { *wk_destroyed = true; });
-#ifdef CXX_EXCEPTIONS
-              } catch (const std::exception& e) {
-                std::string info = e.what();
-                tsfn.BlockingCall(
-                    [info, deferred](Napi::Env env, Napi::Function) {
-                      Napi::Object obj = Napi::Object::New(env);
-                      obj.Set("status", Napi::String::New(env, "error"));
-                      obj.Set("native", true);
-                      obj.Set("result", Napi::String::New(env, info));
-                      deferred.Reject(obj);
-                    });
-                tsfn.Release();
-              }
-#endif
-            }));
-        Napi::Object object = Napi::Object::New(env);
-        object.Set("promise", deferred.Promise());
-        object.Set(
-            "cancel",
-            Napi::Function::New(env, [wk_destroyed, tsfn, ctx, deferred,
-                                      wk](const Napi::CallbackInfo&) mutable {
-              ctx->cancel();
-              if (*wk_destroyed)
-                return;
-#ifdef CXX_EXCEPTIONS
-              try {
-#endif
-                wk->Cancel();
-                Napi::Env env = deferred.Env();
-#ifdef NAPI_DISABLE_CPP_EXCEPTIONS
-                if (env.IsExceptionPending()) {
-                  env.GetAndClearPendingException();
-                  return;
-                }
-#endif
-                tsfn.Release();
-                Napi::Object obj = Napi::Object::New(env);
-                obj.Set("status", Napi::String::New(env, "canceled"));
-                deferred.Reject(obj);
-#ifdef CXX_EXCEPTIONS
-              } catch (Napi::Error&) {
-              }
-#endif
-            }));
-        return object;
-      });
+/**
+ * @brief Same as above, for any callable. It takes a cancel_context_ptr
+ * first if it wants to be told that it is canceled.
+ *
+ * @tparam F
+ * @param env
+ * @param f
+ * @return Napi::Value
+ */
+template <typename F, typename = internal::EnableIfCallable<F>>
+static Napi::Value ToCancellablePromise(
+    const Napi::Env& env, F&& f,
+    promise_executor executor = promise_executor()) {
+  using Callable = std::decay_t<F>;
+  using Traits = internal::CallableTraits<Callable>;
+  return internal::PromiseFunctionFactory<
+      typename Traits::ReturnType, typename Traits::ArgList>::
+      NewCancellable(env,
+                     internal::SharedCallable<Callable>(std::forward<F>(f)),
+                     std::move(executor));
 }
+
+/**
+ * @brief Calls a method of a wrapped object on a worker thread, and returns
+ * a promise of its result.
+ *
+ * The arguments are converted on the thread of the env, and the wrapper of
+ * |info| is kept alive until the promise is settled, so |c| is never
+ * collected while the method runs. Calls of an object run concurrently
+ * unless |executor| has a limit; a concurrency_limit of 1 per object runs
+ * them one at a time in the order they are made, without holding a thread
+ * while they wait.
+ *
+ * @code
+ * Napi::Value RectJs::SizeAsync(const Napi::CallbackInfo& info) {
+ *   return TypedCallAsync(info, &Rect::size, rect_.get(), strand_);
+ * }
+ * @endcode
+ */
+template <typename R, typename Class, typename... Args>
+Napi::Value TypedCallAsync(const Napi::CallbackInfo& info,
+                           R (Class::*f)(Args...), Class* c,
+                           promise_executor executor = promise_executor()) {
+  return internal::StartMethodWork<R, Args...>(
+      info, executor, [f, c](Args... args) -> R { return (c->*f)(args...); });
+}
+
+template <typename R, typename Class, typename... Args>
+Napi::Value TypedCallAsync(const Napi::CallbackInfo& info,
+                           R (Class::*f)(Args...) const, const Class* c,
+                           promise_executor executor = promise_executor()) {
+  return internal::StartMethodWork<R, Args...>(
+      info, executor, [f, c](Args... args) -> R { return (c->*f)(args...); });
+}
+
 }  // namespace node_binding
 
-#endif  // NODE_BINDING_PROMISE_H_
\ No newline at end of file
+#endif  // NODE_BINDING_PROMISE_H_
@@ -0,0 +1,192 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_PROPERTY_KEY_H_
+#define NODE_BINDING_PROPERTY_KEY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
+#include "napi.h"
+#include "node_binding/env_local.h"
+
+namespace node_binding {
+
+namespace internal {
+
+inline size_t NextPropertyKeyId() {
+  static std::atomic<size_t> next_id(0);
+  return next_id++;
+}
+
+// Key strings of an env, indexed by property_key::id().
+//
+// Since N-API 10 each string is referenced directly. Before that a reference
+// can't be created to a string, so the strings are kept as the elements of an
+// Array which is referenced instead, and which ids are filled is tracked
+// natively so that a lookup needn't check the element.
+class PropertyKeyTable {
+ public:
+  explicit PropertyKeyTable(napi_env env)
+      : env_(env),
+#if (NAPI_VERSION <= 9)
+        keys_(nullptr),
+#endif
+        created_(0) {}
+
+  ~PropertyKeyTable() {
+#if (NAPI_VERSION > 9)
+    for (napi_ref ref : refs_) {
+      if (ref) napi_delete_reference(env_, ref);
+    }
+#else
+    if (keys_) napi_delete_reference(env_, keys_);
+#endif
+  }
+
+  // Returns the key string of |id|, which is created from |name| on first
+  // use. |keys| caches the Array of the strings once it is resolved, so a
+  // caller which looks up many keys resolves it once.
+  napi_value Get(size_t id, const char* name, napi_value* keys) {
+    napi_value key = Find(id, keys);
+    if (key) return key;
+    if (napi_create_string_utf8(env_, name, strlen(name), &key) != napi_ok)
+      return nullptr;
+    ++created_;
+    Store(id, key, keys);
+    return key;
+  }
+
+  // The number of key strings which are created so far.
+  size_t created() const { return created_; }
+
+  PropertyKeyTable(const PropertyKeyTable&) = delete;
+  PropertyKeyTable& operator=(const PropertyKeyTable&) = delete;
+
+ private:
+#if (NAPI_VERSION > 9)
+  napi_value Find(size_t id, napi_value* keys) {
+    napi_value key;
+    if (id >= refs_.size() || !refs_[id] ||
+        napi_get_reference_value(env_, refs_[id], &key) != napi_ok) {
+      return nullptr;
+    }
+    return key;
+  }
+
+  void Store(size_t id, napi_value key, napi_value* keys) {
+    if (id >= refs_.size()) refs_.resize(id + 1, nullptr);
+    if (napi_create_reference(env_, key, 1, &refs_[id]) != napi_ok)
+      refs_[id] = nullptr;
+  }
+#else
+  napi_value Find(size_t id, napi_value* keys) {
+    napi_value key;
+    if (id >= filled_.size() || !filled_[id] || !Resolve(keys) ||
+        napi_get_element(env_, *keys, static_cast<uint32_t>(id), &key) !=
+            napi_ok) {
+      return nullptr;
+    }
+    return key;
+  }
+
+  void Store(size_t id, napi_value key, napi_value* keys) {
+    if (!keys_) {
+      napi_value array;
+      if (napi_create_array(env_, &array) != napi_ok ||
+          napi_create_reference(env_, array, 1, &keys_) != napi_ok) {
+        keys_ = nullptr;
+        return;
+      }
+      *keys = array;
+    }
+    if (!Resolve(keys) ||
+        napi_set_element(env_, *keys, static_cast<uint32_t>(id), key) !=
+            napi_ok) {
+      return;
+    }
+    if (id >= filled_.size()) filled_.resize(id + 1, false);
+    filled_[id] = true;
+  }
+
+  bool Resolve(napi_value* keys) {
+    if (*keys) return true;
+    if (!keys_ || napi_get_reference_value(env_, keys_, keys) != napi_ok) {
+      *keys = nullptr;
+      return false;
+    }
+    return true;
+  }
+#endif
+
+  napi_env env_;
+#if (NAPI_VERSION > 9)
+  std::vector<napi_ref> refs_;
+#else
+  napi_ref keys_;
+  std::vector<bool> filled_;
+#endif
+  size_t created_;
+};
+
+// The key strings which one conversion looks up. The table of the env, and
+// its Array before N-API 10, are resolved once rather than per key.
+class PropertyKeys {
+ public:
+  explicit PropertyKeys(napi_env env)
+      : table_(EnvLocal<PropertyKeyTable>::Get(env)), keys_(nullptr) {}
+
+  napi_value Get(size_t id, const char* name) {
+    return table_.Get(id, name, &keys_);
+  }
+
+  PropertyKeys(const PropertyKeys&) = delete;
+  PropertyKeys& operator=(const PropertyKeys&) = delete;
+
+ private:
+  PropertyKeyTable& table_;
+  napi_value keys_;
+};
+
+}  // namespace internal
+
+/**
+ * @brief Handle of an interned property key.
+ *
+ * The JS string is created once per env and kept alive until the env is torn
+ * down, so looking up a property by it doesn't create a new key string every
+ * time. Define it with static storage duration.
+ *
+ * @code
+ * static const node_binding::property_key kX("x");
+ * Napi::Value x = obj.Get(kX.Value(env));
+ * @endcode
+ */
+class property_key {
+ public:
+  explicit property_key(const char* name)
+      : name_(name), id_(internal::NextPropertyKeyId()) {}
+
+  const char* name() const { return name_; }
+  size_t id() const { return id_; }
+
+  Napi::String Value(napi_env env) const {
+    return Napi::String(env, internal::PropertyKeys(env).Get(id_, name_));
+  }
+
+  property_key(const property_key&) = delete;
+  property_key& operator=(const property_key&) = delete;
+
+ private:
+  const char* name_;
+  size_t id_;
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_PROPERTY_KEY_H_
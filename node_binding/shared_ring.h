@@ -0,0 +1,390 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_SHARED_RING_H_
+#define NODE_BINDING_SHARED_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/completion_queue.h"
+#include "node_binding/type_convertor.h"
+#include "node_binding/typed_array.h"
+
+namespace node_binding {
+
+namespace internal {
+
+template <typename T>
+class SharedRingReader;
+
+}  // namespace internal
+
+/**
+ * @brief Where a node_binding::shared_ring keeps its state in its
+ * ArrayBuffer, so that JS can read it by an Int32Array of the header.
+ *
+ * The cursors count items from the start and wrap around at 2^32; the item
+ * of cursor c is at c & (capacity - 1). In JS they are Int32 values, so
+ * compare them by === and advance them by (c + 1) | 0.
+ */
+struct shared_ring_layout {
+  // Int32 index of the cursor up to which items are written.
+  static constexpr size_t kWriteIndex = 0;
+  // Int32 index of the cursor up to which items are read. Only JS moves it.
+  static constexpr size_t kReadIndex = 16;
+  // Int32 index of the flag which is set once no more items come.
+  static constexpr size_t kClosedIndex = 32;
+  // Int32 index of the capacity, which is a power of two.
+  static constexpr size_t kCapacityIndex = 33;
+  // Byte offset of the first item.
+  static constexpr size_t kHeaderSize = 256;
+};
+
+/**
+ * @brief A ring buffer in an ArrayBuffer, through which native threads
+ * stream numbers to JS without a call into N-API per item.
+ *
+ * Producers on any thread call TryPush(), which is lock-free: it reserves
+ * slots by a compare-and-swap, copies the items and publishes them by a
+ * store of the write cursor. Producers which push at a time publish in the
+ * order they reserve, so one which is preempted in between holds the others
+ * back until it runs again. JS reads the items right out of the buffer and
+ * stores the read cursor by Atomics, and calls wait() only when the ring is
+ * empty. The thread of the env is woken up only when a producer pushes to a
+ * ring which JS waits for, so items are delivered in batches.
+ *
+ * N-API can't create a SharedArrayBuffer over native memory, so the buffer
+ * is an external ArrayBuffer. Atomics.load() and Atomics.store() work on
+ * it, but Atomics.wait() doesn't; JS waits by wait() instead.
+ *
+ * @code
+ * auto ring = std::make_shared<node_binding::shared_ring<double>>(1 << 16);
+ * std::thread([ring, feed] {
+ *   while (feed->Next(&tick)) {
+ *     if (!ring->TryPush(tick.price)) ++dropped;
+ *   }
+ *   ring->Close();
+ * }).detach();
+ * return ring;
+ * @endcode
+ *
+ * @code
+ * const {header, items, capacity} = ring;
+ * for (;;) {
+ *   // Read before the write cursor, so that no item is missed at the end.
+ *   const closed = Atomics.load(header, 32);
+ *   const write = Atomics.load(header, 0);
+ *   let read = Atomics.load(header, 16);
+ *   if (read === write) {
+ *     if (closed) break;
+ *     await ring.wait();
+ *     continue;
+ *   }
+ *   for (; read !== write; read = (read + 1) | 0) {
+ *     onTick(items[read & (capacity - 1)]);
+ *   }
+ *   Atomics.store(header, 16, read);
+ * }
+ * @endcode
+ *
+ * @tparam T an arithmetic type which has a corresponding TypedArray.
+ */
+template <typename T>
+class shared_ring {
+  static_assert(internal::TypedArrayTraits<T>::kSupported,
+                "shared_ring<T> requires T to be an arithmetic type "
+                "which has a corresponding TypedArray.");
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                    ATOMIC_INT_LOCK_FREE == 2,
+                "The cursors have to be lock-free words");
+
+ public:
+  static constexpr size_t kDefaultCapacity = 4096;
+  static constexpr size_t kMaxCapacity = size_t(1) << 30;
+
+  // |capacity| is rounded up to a power of two.
+  explicit shared_ring(size_t capacity = kDefaultCapacity)
+      : capacity_(RoundUp(capacity)),
+        memory_(new uint64_t[(shared_ring_layout::kHeaderSize +
+                              capacity_ * sizeof(T) + 7) /
+                             8]()),
+        reserve_(0),
+        waiting_(false) {
+    for (size_t i = 0; i < shared_ring_layout::kHeaderSize / 4; ++i)
+      new (&Word(i)) std::atomic<uint32_t>(0);
+    Word(shared_ring_layout::kCapacityIndex)
+        .store(static_cast<uint32_t>(capacity_), std::memory_order_relaxed);
+  }
+
+  shared_ring(const shared_ring&) = delete;
+  shared_ring& operator=(const shared_ring&) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  // Can be called on any thread. Pushes every one of |values| in a row, or
+  // none of them and returns false if the ring has less room.
+  bool TryPush(const T* values, size_t count) {
+    if (count > capacity_) return false;
+    uint32_t n = static_cast<uint32_t>(count);
+    uint32_t start = reserve_.load(std::memory_order_relaxed);
+    do {
+      uint32_t read = Word(shared_ring_layout::kReadIndex)
+                          .load(std::memory_order_acquire);
+      if (capacity_ - (start - read) < n) return false;
+    } while (!reserve_.compare_exchange_weak(start, start + n,
+                                             std::memory_order_relaxed));
+
+    T* items = Items();
+    uint32_t mask = static_cast<uint32_t>(capacity_ - 1);
+    for (uint32_t i = 0; i < n; ++i) items[(start + i) & mask] = values[i];
+
+    std::atomic<uint32_t>& write = Word(shared_ring_layout::kWriteIndex);
+    while (write.load(std::memory_order_acquire) != start)
+      std::this_thread::yield();
+    write.store(start + n, std::memory_order_seq_cst);
+    Wake();
+    return true;
+  }
+
+  bool TryPush(const T& value) { return TryPush(&value, 1); }
+
+  // Can be called on any thread. JS reads the items which are pushed so far
+  // and then ends.
+  void Close() {
+    Word(shared_ring_layout::kClosedIndex)
+        .store(1, std::memory_order_seq_cst);
+    Wake();
+  }
+
+ private:
+  friend class internal::SharedRingReader<T>;
+  friend class TypeConvertor<std::shared_ptr<shared_ring<T>>>;
+
+  static size_t RoundUp(size_t capacity) {
+    size_t ret = 1;
+    while (ret < capacity && ret < kMaxCapacity) ret <<= 1;
+    return ret;
+  }
+
+  std::atomic<uint32_t>& Word(size_t index) {
+    return reinterpret_cast<std::atomic<uint32_t>*>(memory_.get())[index];
+  }
+
+  T* Items() {
+    return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(memory_.get()) +
+                                shared_ring_layout::kHeaderSize);
+  }
+
+  size_t byte_length() const {
+    return shared_ring_layout::kHeaderSize + capacity_ * sizeof(T);
+  }
+
+  bool Readable() {
+    return Word(shared_ring_layout::kWriteIndex)
+                   .load(std::memory_order_seq_cst) !=
+               Word(shared_ring_layout::kReadIndex)
+                   .load(std::memory_order_relaxed) ||
+           Word(shared_ring_layout::kClosedIndex)
+                   .load(std::memory_order_seq_cst) != 0;
+  }
+
+  // Called on the thread of the env before JS can wait.
+  void Listen(std::shared_ptr<completion_queue> queue,
+              completion_queue::completion wake) {
+    queue_ = std::move(queue);
+    wake_ = std::move(wake);
+  }
+
+  // Called on the thread of the env. Returns true if there is something to
+  // read already; otherwise |wake_| is pushed to the queue once there is.
+  bool Arm() {
+    waiting_.store(true, std::memory_order_seq_cst);
+    if (!Readable()) return false;
+    // A producer which takes the flag first pushes |wake_| anyway.
+    return waiting_.exchange(false, std::memory_order_acq_rel);
+  }
+
+  void Wake() {
+    if (waiting_.load(std::memory_order_seq_cst) &&
+        waiting_.exchange(false, std::memory_order_acq_rel)) {
+      queue_->Push(wake_);
+    }
+  }
+
+  size_t capacity_;
+  std::unique_ptr<uint64_t[]> memory_;
+  // The cursor up to which slots are reserved by producers.
+  std::atomic<uint32_t> reserve_;
+  std::atomic_bool waiting_;
+  std::shared_ptr<completion_queue> queue_;
+  completion_queue::completion wake_;
+};
+
+namespace internal {
+
+// The JS side of a shared_ring, which settles wait() once a producer pushes.
+template <typename T>
+class SharedRingReader
+    : public std::enable_shared_from_this<SharedRingReader<T>> {
+ public:
+  explicit SharedRingReader(std::shared_ptr<shared_ring<T>> ring)
+      : ring_(std::move(ring)) {}
+
+  void Listen(Napi::Env env) {
+    queue_ = completion_queue::Get(env);
+    std::weak_ptr<SharedRingReader> self = this->shared_from_this();
+    ring_->Listen(queue_, [self](Napi::Env env) {
+      if (std::shared_ptr<SharedRingReader> reader = self.lock())
+        reader->Settle(env);
+    });
+  }
+
+  Napi::Value Wait(Napi::Env env) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    pending_.push_back(deferred);
+    if (pending_.size() == 1) {
+      if (ring_->Arm()) {
+        Settle(env);
+      } else {
+        // Dropped by the completion which wakes it up.
+        queue_->Ref();
+      }
+    }
+    return deferred.Promise();
+  }
+
+  // Copies out the items which are pushed so far, and frees their slots.
+  Napi::Value Read(Napi::Env env) {
+    std::atomic<uint32_t>& read_cursor =
+        ring_->Word(shared_ring_layout::kReadIndex);
+    uint32_t write = ring_->Word(shared_ring_layout::kWriteIndex)
+                         .load(std::memory_order_acquire);
+    uint32_t read = read_cursor.load(std::memory_order_relaxed);
+    size_t length = write - read;
+    void* data;
+    napi_value arraybuffer;
+    if (napi_create_arraybuffer(env, length * sizeof(T), &data,
+                                &arraybuffer) != napi_ok) {
+      return Napi::Value();
+    }
+
+    const T* items = ring_->Items();
+    size_t mask = ring_->capacity() - 1;
+    size_t first = read & mask;
+    size_t head = std::min(length, ring_->capacity() - first);
+    memcpy(data, items + first, head * sizeof(T));
+    memcpy(static_cast<T*>(data) + head, items, (length - head) * sizeof(T));
+    read_cursor.store(write, std::memory_order_release);
+    return NewTypedArray<T>(env, arraybuffer, length);
+  }
+
+ private:
+  void Settle(Napi::Env env) {
+    std::deque<Napi::Promise::Deferred> pending;
+    pending.swap(pending_);
+    for (Napi::Promise::Deferred& deferred : pending)
+      deferred.Resolve(env.Undefined());
+  }
+
+  std::shared_ptr<shared_ring<T>> ring_;
+  std::shared_ptr<completion_queue> queue_;
+  std::deque<Napi::Promise::Deferred> pending_;
+};
+
+}  // namespace internal
+
+/**
+ * @brief std::shared_ptr<node_binding::shared_ring<T>> --> Object
+ *
+ * Convert a ring once; the buffer stays alive as long as the object or the
+ * producers which hold the ring.
+ *
+ * @code
+ * {
+ *   buffer: ArrayBuffer,
+ *   header: Int32Array,  // indexed by node_binding::shared_ring_layout
+ *   items: TypedArray,   // e.g. Float64Array for shared_ring<double>
+ *   capacity: number,
+ *   layout: {write, read, closed, capacity},  // Int32 indices of header
+ *   wait(): Promise<void>,  // settled once the ring isn't empty or closed
+ *   read(): TypedArray,     // copies out the items which are pushed so far
+ * }
+ * @endcode
+ *
+ * @tparam T
+ */
+template <typename T>
+class TypeConvertor<std::shared_ptr<shared_ring<T>>> {
+ public:
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const std::shared_ptr<shared_ring<T>>& value) {
+    if (!value) return env.Null();
+
+    napi_value arraybuffer;
+    std::shared_ptr<shared_ring<T>>* hint =
+        new std::shared_ptr<shared_ring<T>>(value);
+    napi_status status = napi_create_external_arraybuffer(
+        env, value->memory_.get(), value->byte_length(),
+        [](napi_env env, void* data, void* hint) {
+          delete static_cast<std::shared_ptr<shared_ring<T>>*>(hint);
+        },
+        hint, &arraybuffer);
+    if (status != napi_ok) {
+      // e.g, napi_no_external_buffers_allowed.
+      delete hint;
+      Napi::Error::New(env, "shared_ring needs external buffers")
+          .ThrowAsJavaScriptException();
+      return Napi::Value();
+    }
+
+    std::shared_ptr<internal::SharedRingReader<T>> reader =
+        std::make_shared<internal::SharedRingReader<T>>(value);
+    reader->Listen(env);
+
+    Napi::Object ring = Napi::Object::New(env);
+    ring.Set("buffer", Napi::Value(env, arraybuffer));
+    ring.Set("header",
+             internal::NewTypedArray<int32_t>(
+                 env, arraybuffer, shared_ring_layout::kHeaderSize / 4));
+    napi_value items;
+    napi_create_typedarray(env, internal::TypedArrayTraits<T>::kType,
+                           value->capacity(), arraybuffer,
+                           shared_ring_layout::kHeaderSize, &items);
+    ring.Set("items", Napi::Value(env, items));
+    ring.Set("capacity", static_cast<double>(value->capacity()));
+    Napi::Object layout = Napi::Object::New(env);
+    layout.Set("write",
+               static_cast<double>(shared_ring_layout::kWriteIndex));
+    layout.Set("read", static_cast<double>(shared_ring_layout::kReadIndex));
+    layout.Set("closed",
+               static_cast<double>(shared_ring_layout::kClosedIndex));
+    layout.Set("capacity",
+               static_cast<double>(shared_ring_layout::kCapacityIndex));
+    ring.Set("layout", layout);
+    ring.Set("wait",
+             Napi::Function::New(env, [reader](const Napi::CallbackInfo& info) {
+               return reader->Wait(info.Env());
+             }));
+    ring.Set("read",
+             Napi::Function::New(env, [reader](const Napi::CallbackInfo& info) {
+               return reader->Read(info.Env());
+             }));
+    return ring;
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_SHARED_RING_H_
@@ -0,0 +1,289 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_SPAN_H_
+#define NODE_BINDING_SPAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "node_binding/build_config.h"
+
+#if CXX_VER >= 201703
+#include <string_view>
+#endif
+
+#include "napi.h"
+#include "node_binding/type_convertor.h"
+#include "node_binding/typed_array.h"
+
+namespace node_binding {
+
+/**
+ * @brief A non-owning view of contiguous elements.
+ *
+ * When it is used as a parameter type, it points directly into the backing
+ * store of a TypedArray, Buffer, DataView or ArrayBuffer, so nothing is
+ * allocated or copied. The view is valid only during the synchronous call;
+ * don't keep it after the bound function returns. A function of ToPromise()
+ * gets a view of a copy instead, which lives as long as its job.
+ *
+ * @tparam T
+ */
+template <typename T>
+class span {
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = size_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  constexpr span() noexcept : data_(nullptr), size_(0) {}
+  constexpr span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+  template <typename U,
+            std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>* =
+                nullptr>
+  constexpr span(const span<U>& other) noexcept
+      : data_(other.data()), size_(other.size()) {}
+
+  constexpr T* data() const noexcept { return data_; }
+  constexpr size_t size() const noexcept { return size_; }
+  constexpr size_t size_bytes() const noexcept { return size_ * sizeof(T); }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+
+  constexpr T& operator[](size_t i) const { return data_[i]; }
+
+  constexpr iterator begin() const noexcept { return data_; }
+  constexpr iterator end() const noexcept { return data_ + size_; }
+
+  constexpr span subspan(size_t offset, size_t count) const {
+    return span(data_ + offset, count);
+  }
+
+ private:
+  T* data_;
+  size_t size_;
+};
+
+using byte_view = span<const uint8_t>;
+
+namespace internal {
+
+template <typename T>
+struct IsBorrowedArg<span<T>> : std::true_type {};
+
+// ToPromise() copies a span<const T> for its job. A span<T> would write
+// only into the copy, so it is rejected instead.
+template <typename T>
+struct OwnedArg<span<T>> {
+  static_assert(std::is_const<T>::value,
+                "An asynchronous call can't write into a TypedArray through "
+                "span<T>; take span<const T> and return the result instead.");
+
+  using type = std::vector<std::remove_cv_t<T>>;
+
+  static type Own(span<T> value) { return type(value.begin(), value.end()); }
+  static span<T> Borrow(const type& value) {
+    return span<T>(value.data(), value.size());
+  }
+};
+
+#if CXX_VER >= 201703
+template <>
+struct IsBorrowedArg<std::string_view> : std::true_type {};
+
+template <>
+struct OwnedArg<std::string_view> {
+  using type = std::string;
+
+  static type Own(std::string_view value) { return type(value); }
+  static std::string_view Borrow(const type& value) { return value; }
+};
+#endif
+
+constexpr int kNoElementType = -1;
+
+// Returns true and fills |data| and |byte_length| with the backing store of
+// |value| if it is a TypedArray (including Buffer), DataView or ArrayBuffer.
+// |type| is set to the napi_typedarray_type of a TypedArray, otherwise
+// kNoElementType.
+inline bool GetBackingStore(const Napi::Value& value, void** data,
+                            size_t* byte_length, int* type) {
+  napi_env env = value.Env();
+  bool result;
+  if (napi_is_typedarray(env, value, &result) == napi_ok && result) {
+    napi_typedarray_type array_type;
+    size_t length;
+    napi_value arraybuffer;
+    size_t byte_offset;
+    if (napi_get_typedarray_info(env, value, &array_type, &length, data,
+                                 &arraybuffer, &byte_offset) != napi_ok)
+      return false;
+    size_t element_size;
+    switch (array_type) {
+      case napi_int8_array:
+      case napi_uint8_array:
+      case napi_uint8_clamped_array:
+        element_size = 1;
+        break;
+      case napi_int16_array:
+      case napi_uint16_array:
+        element_size = 2;
+        break;
+      case napi_int32_array:
+      case napi_uint32_array:
+      case napi_float32_array:
+        element_size = 4;
+        break;
+      default:
+        element_size = 8;
+        break;
+    }
+    *byte_length = length * element_size;
+    *type = array_type;
+    return true;
+  }
+  if (napi_is_dataview(env, value, &result) == napi_ok && result) {
+    *type = kNoElementType;
+    return napi_get_dataview_info(env, value, byte_length, data, nullptr,
+                                  nullptr) == napi_ok;
+  }
+  if (napi_is_arraybuffer(env, value, &result) == napi_ok && result) {
+    *type = kNoElementType;
+    return napi_get_arraybuffer_info(env, value, data, byte_length) ==
+           napi_ok;
+  }
+  return false;
+}
+
+// Checks whether the backing store can be viewed as elements of T. A
+// TypedArray has to have the same element type, unless T is a byte in which
+// case any view is accepted. An untyped view has to be aligned to T and its
+// length has to be a multiple of sizeof(T).
+template <typename T>
+bool IsViewableAs(const void* data, size_t byte_length, int type) {
+  using U = std::remove_cv_t<T>;
+  if (type != kNoElementType && sizeof(U) > 1) {
+    return TypedArrayTraits<U>::Matches(static_cast<napi_typedarray_type>(type));
+  }
+  return byte_length % sizeof(U) == 0 &&
+         reinterpret_cast<uintptr_t>(data) % alignof(U) == 0;
+}
+
+}  // namespace internal
+
+/**
+ * @brief node_binding::span<T> <-- TypedArray, Buffer, DataView or ArrayBuffer
+ *
+ * @tparam T
+ */
+template <typename T>
+class TypeConvertor<span<T>> {
+  static_assert(internal::TypedArrayTraits<std::remove_cv_t<T>>::kSupported,
+                "span<T> requires T to be an arithmetic type which has a "
+                "corresponding TypedArray.");
+
+ public:
+  static span<T> ToNativeValue(const Napi::Value& value) {
+    void* data;
+    size_t byte_length;
+    int type;
+    if (!internal::GetBackingStore(value, &data, &byte_length, &type))
+      return span<T>();
+    return span<T>(static_cast<T*>(data), byte_length / sizeof(T));
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    void* data;
+    size_t byte_length;
+    int type;
+    return internal::GetBackingStore(value, &data, &byte_length, &type) &&
+           internal::IsViewableAs<T>(data, byte_length, type);
+  }
+
+  static bool TryToNativeValue(const Napi::Value& value, span<T>* out) {
+    void* data;
+    size_t byte_length;
+    int type;
+    if (!internal::GetBackingStore(value, &data, &byte_length, &type) ||
+        !internal::IsViewableAs<T>(data, byte_length, type))
+      return false;
+    *out = span<T>(static_cast<T*>(data), byte_length / sizeof(T));
+    return true;
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env, const span<T>& value) {
+    return internal::CopyToTypedArray<std::remove_cv_t<T>>(env, value.data(),
+                                                            value.size());
+  }
+};
+
+#if CXX_VER >= 201703
+/**
+ * @brief std::string_view <-- string, Buffer, TypedArray, DataView or
+ * ArrayBuffer
+ *
+ * A string is converted to UTF-8 into a per-thread buffer which is reused by
+ * the next call. Otherwise, the view points directly into the backing store.
+ * Either way, it is valid only during the synchronous call.
+ */
+template <>
+class TypeConvertor<std::string_view> {
+ public:
+  static std::string_view ToNativeValue(const Napi::Value& value) {
+    if (value.IsString()) {
+      size_t length;
+      const char* data = internal::Utf8ValueInArena(value, &length);
+      return std::string_view(data, length);
+    }
+
+    void* data;
+    size_t byte_length;
+    int type;
+    if (!internal::GetBackingStore(value, &data, &byte_length, &type))
+      return std::string_view();
+    return std::string_view(static_cast<const char*>(data), byte_length);
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    if (value.IsString()) return true;
+
+    void* data;
+    size_t byte_length;
+    int type;
+    return internal::GetBackingStore(value, &data, &byte_length, &type);
+  }
+
+  static bool TryToNativeValue(const Napi::Value& value,
+                               std::string_view* out) {
+    if (value.IsString()) {
+      *out = ToNativeValue(value);
+      return true;
+    }
+
+    void* data;
+    size_t byte_length;
+    int type;
+    if (!internal::GetBackingStore(value, &data, &byte_length, &type))
+      return false;
+    *out = std::string_view(static_cast<const char*>(data), byte_length);
+    return true;
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env, std::string_view value) {
+    return Napi::String::New(env, value.data(), value.size());
+  }
+};
+#endif
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_SPAN_H_
@@ -5,43 +5,34 @@
 #ifndef NODE_BINDING_STL_H_
 #define NODE_BINDING_STL_H_
 
-#if defined(_MSVC_LANG)
-#define CXX_VER _MSVC_LANG
-#else
-#define CXX_VER __cplusplus
-#endif
-
-#ifdef __cpp_exceptions
-#define CXX_EXCEPTIONS
-#endif
-
-#if defined(__clang__)
-#if __has_feature(cxx_rtti)
-#define CXX_RTTI
-#endif
-#elif defined(__GNUG__)
-#if defined(__GXX_RTTI)
-#define CXX_RTTI
-#endif
-#elif defined(_MSC_VER)
-#if defined(_CPPRTTI)
-#define CXX_RTTI
-#endif
-#endif
+#include "node_binding/build_config.h"
 
 #if CXX_VER >= 201703
 #include <any>
 #include <unordered_map>
 #endif
 
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
-#include <future>
-#include <shared_mutex>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "node_binding/env_local.h"
 #include "node_binding/type_convertor.h"
+#include "node_binding/typed_array.h"
 #include "node_binding/typed_call.h"
 
 namespace node_binding {
@@ -49,6 +40,9 @@ namespace node_binding {
 /**
  * @brief std::vector<T> <-> Napi::Array
  *
+ * A TypedArray whose element type is T is also accepted and copied with a
+ * single memcpy. Use node_binding::typed_array<T> to return a TypedArray.
+ *
  * @tparam T
  */
 template <typename T>
@@ -64,25 +58,45 @@ class TypeConvertor<std::vector<T>> {
 #endif
   static std::vector<NativeValueType> ToNativeValue(const Napi::Value& value) {
     std::vector<NativeValueType> ret;
+    if (internal::CopyFromTypedArray(value, &ret)) return ret;
+
     Napi::Array arr = value.As<Napi::Array>();
-    ret.reserve(arr.Length());
-    for (size_t i = 0; i < arr.Length(); ++i) {
+    uint32_t arr_length = arr.Length();
+    ret.reserve(arr_length);
+    for (uint32_t i = 0; i < arr_length; ++i) {
       ret.push_back(TypeConvertor<T>::ToNativeValue(arr[i]));
     }
     return ret;
   }
 
   static bool IsConvertible(const Napi::Value& value) {
+    if (value.IsTypedArray()) return internal::IsTypedArrayOf<T>(value);
     if (!value.IsArray())
       return false;
     Napi::Array arr = value.As<Napi::Array>();
-    for (size_t i = 0; i < arr.Length(); ++i) {
+    uint32_t arr_length = arr.Length();
+    for (uint32_t i = 0; i < arr_length; ++i) {
       if (!TypeConvertor<T>::IsConvertible(arr[i]))
         return false;
     }
     return true;
   }
 
+  static bool TryToNativeValue(const Napi::Value& value, std::vector<T>* out) {
+    if (value.IsTypedArray()) return internal::CopyFromTypedArray(value, out);
+    if (!value.IsArray())
+      return false;
+    Napi::Array arr = value.As<Napi::Array>();
+    uint32_t arr_length = arr.Length();
+    out->clear();
+    out->reserve(arr_length);
+    for (uint32_t i = 0; i < arr_length; ++i) {
+      if (!internal::AppendNativeValue(arr.Get(i), out))
+        return false;
+    }
+    return true;
+  }
+
   static Napi::Value ToJSValue(const Napi::Env& env,
                                const std::vector<T>& value) {
     Napi::Array ret = Napi::Array::New(env, value.size());
@@ -124,95 +138,628 @@ class TypeConvertor<void (*)(Args...)> {
 };
 
 #if (NAPI_VERSION > 3)
-/**
- * @brief node_binding::thread_safe_function<function<?>>
- *
- * @tparam T
- */
-template <typename Fty_>
-class thread_safe_function : public std::function<Fty_> {
-  using T = std::function<Fty_>;
+// How a node_binding::thread_safe_function queues the calls of workers
+// while the thread of the env is busy.
+namespace tsfn_queue {
 
+// Queues every call. This is the default.
+struct unbounded {
+  static constexpr size_t kMaxSize = 0;
+  static constexpr bool kDrops = false;
+};
+
+// A call blocks the worker while |N| calls are queued, which applies
+// backpressure to a producer that outpaces JS.
+template <size_t N>
+struct bounded {
+  static constexpr size_t kMaxSize = N > 0 ? N : 1;
+  static constexpr bool kDrops = false;
+};
+
+// Keeps the newest |N| calls. A call which finds |N| queued drops the
+// oldest one, e.g. for telemetry. Only for functions which return void.
+template <size_t N>
+struct drop_oldest {
+  static constexpr size_t kMaxSize = N > 0 ? N : 1;
+  static constexpr bool kDrops = true;
+};
+
+// Keeps only the newest call, e.g. for progress or state updates of which
+// JS needs only the latest one. Only for functions which return void.
+struct coalesce_latest : drop_oldest<1> {};
+
+}  // namespace tsfn_queue
+
+namespace internal {
+
+// Calls |fn| with |args| and converts its result into R. |fn| is empty
+// once a cached JS function is collected.
+template <typename R>
+struct JsCall {
+  template <size_t... I, typename Tuple>
+  static R Run(const Napi::Function& fn, std::index_sequence<I...> indices,
+               Tuple& args) {
+    if (fn.IsEmpty()) return R();
+    return node_binding::Invoke<R>(fn, indices, args);
+  }
+};
+
+template <>
+struct JsCall<void> {
+  template <size_t... I, typename Tuple>
+  static void Run(const Napi::Function& fn, std::index_sequence<I...> indices,
+                  Tuple& args) {
+    if (fn.IsEmpty()) return;
+    node_binding::Invoke(fn, indices, args);
+  }
+};
+
+// The reply of a call into JS, which the thread of the env sets once and a
+// worker waits for.
+//
+// Setting it is an atomic exchange unless the worker already sleeps on it.
+// The worker spins for a while before it sleeps, as the reply of a short JS
+// callback usually comes within that.
+class ReplySlotBase {
  public:
-  thread_safe_function() : ptsfn_(nullptr) {}
+  ReplySlotBase() : ok_(false), state_(kEmpty), notified_(false) {}
+
+  ReplySlotBase(const ReplySlotBase&) = delete;
+  ReplySlotBase& operator=(const ReplySlotBase&) = delete;
 
-  thread_safe_function(const thread_safe_function& other)
-      : T(*static_cast<const T*>(&other)) {
+  bool ready() const {
+    return state_.load(std::memory_order_acquire) == kReady;
+  }
+
+  // Whether the call is made, once the slot is ready.
+  bool ok() const { return ok_; }
+
+  // Sets the reply of a call which couldn't be queued.
+  void Fail() { Publish(); }
+
+  void Wait() {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (ready()) return;
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    int expected = kEmpty;
+    if (!state_.compare_exchange_strong(expected, kWaiting,
+                                        std::memory_order_acq_rel)) {
+      return;
+    }
+    // Waits for |notified_| rather than the state, so that the slot outlives
+    // the notification even if it lives on the stack of the worker.
+    cv_.wait(lock, [this] { return notified_; });
+  }
+
+ protected:
+  // Throws std::runtime_error for a failed call, or aborts without C++
+  // exceptions.
+  static void ThrowFailed() {
 #ifdef CXX_EXCEPTIONS
-    if (!other.ptsfn_)
-      throw std::runtime_error("invalid object");
+    throw std::runtime_error("the call of a thread safe function failed");
+#else
+    abort();
 #endif
-    ptsfn_ = std::move(other.ptsfn_);
   }
 
-  thread_safe_function(T fn) : T(fn) {}
+  void Publish() {
+    if (state_.exchange(kReady, std::memory_order_acq_rel) != kWaiting)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    notified_ = true;
+    cv_.notify_one();
+  }
+
+ private:
+  enum State { kEmpty, kWaiting, kReady };
+
+  static constexpr int kSpinCount = 128;
 
-  thread_safe_function(Napi::ThreadSafeFunction& tsfn, T fn) : T(fn) {
-    ptsfn_ = std::make_unique<Napi::ThreadSafeFunction>(tsfn);
+ protected:
+  // Published by |state_|.
+  bool ok_;
+
+ private:
+  std::atomic<int> state_;
+  bool notified_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+// The reference of the JS function which a cached thread safe function
+// calls. It is deleted by the finalizer of the thread safe function.
+//
+// It also tracks the replies of the calls in flight. A call which is still
+// queued when the thread safe function is aborted is never run, so the
+// finalizer fails its reply rather than leaves its worker waiting. Whichever
+// side takes a reply off the list sets it.
+struct TsfnTarget {
+  TsfnTarget() : ref(nullptr), closed(false) {}
+
+  void Track(ReplySlotBase* slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(slot);
   }
 
-  ~thread_safe_function() { release(); }
+  bool Untrack(ReplySlotBase* slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find(pending.begin(), pending.end(), slot);
+    if (it == pending.end()) return false;
+    pending.erase(it);
+    return true;
+  }
 
-  thread_safe_function& operator=(const thread_safe_function& rhs) {
-    std::unique_lock<std::mutex> lk0(copy_op_mtx_);
-    std::unique_lock<std::mutex> lk1(rhs.copy_op_mtx_);
+  void FailPending() {
+    std::vector<ReplySlotBase*> slots;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      slots.swap(pending);
+    }
+    for (ReplySlotBase* slot : slots) slot->Fail();
+  }
 
-    // 이미 tsfn을 소유한 객체인 경우, 예외를 전달합니다.
-    if (ptsfn_) {
-#ifdef CXX_EXCEPTIONS
-      throw std::runtime_error("already initialized");
-#endif
-      return *this;
+  napi_ref ref;
+  std::atomic_bool closed;
+  std::mutex mutex;
+  std::vector<ReplySlotBase*> pending;
+};
+
+// Owns a thread safe function, which is released with the last
+// node_binding::thread_safe_function that leases it, or by the cache of the
+// env once its JS function is collected.
+//
+// The thread safe function calls a placeholder, and a call looks up the JS
+// function by a reference instead. The reference is strong and the thread
+// safe function keeps the loop alive only while the handle is leased, so an
+// idle handle in the cache neither keeps its JS function alive nor holds the
+// process open.
+class TsfnHandle : public std::enable_shared_from_this<TsfnHandle> {
+ public:
+  // Must be called on the thread of the env.
+  TsfnHandle(const Napi::Function& fn, size_t max_queue_size)
+      : env_(fn.Env()),
+        target_(std::make_shared<TsfnTarget>()),
+        max_queue_size_(max_queue_size),
+        leases_(0),
+        active_(true),
+        main_thread_(std::this_thread::get_id()) {
+    napi_create_reference(env_, fn, 1, &target_->ref);
+    std::shared_ptr<TsfnTarget> target = target_;
+    tsfn_ = Napi::ThreadSafeFunction::New(
+        env_, Napi::Function::New(env_, [](const Napi::CallbackInfo&) {}),
+        "thread safe function resource", max_queue_size, 1,
+        [target](Napi::Env env) {
+          napi_delete_reference(env, target->ref);
+          target->ref = nullptr;
+          target->closed = true;
+          target->FailPending();
+        });
+  }
+
+  ~TsfnHandle() {
+    if (!target_->closed) tsfn_.Release();
+  }
+
+  TsfnHandle(const TsfnHandle&) = delete;
+  TsfnHandle& operator=(const TsfnHandle&) = delete;
+
+  size_t max_queue_size() const { return max_queue_size_; }
+
+  bool OnMainThread() const {
+    return std::this_thread::get_id() == main_thread_;
+  }
+
+  // Must be called on the thread of the env. Returns an empty function once
+  // the JS function is collected.
+  Napi::Function Target() const { return Target(env_, *target_); }
+
+  // Queues |callback|, which is called with the JS function on the thread of
+  // the env.
+  template <typename Callback>
+  napi_status BlockingCall(Callback callback) const {
+    std::shared_ptr<TsfnTarget> target = target_;
+    return tsfn_.BlockingCall(
+        [target, callback](Napi::Env env, Napi::Function) mutable {
+          callback(env, Target(env, *target));
+        });
+  }
+
+  // Queues |callback| like BlockingCall(), and fails |slot| instead if the
+  // call is never run. |callback| sets |slot|, which must stay alive until it
+  // is set.
+  template <typename Callback>
+  void CallForReply(ReplySlotBase* slot, Callback callback) const {
+    target_->Track(slot);
+    std::shared_ptr<TsfnTarget> target = target_;
+    napi_status status = tsfn_.BlockingCall(
+        [target, slot, callback](Napi::Env env, Napi::Function) mutable {
+          if (!target->Untrack(slot)) return;
+          callback(env, Target(env, *target));
+        });
+    if (status != napi_ok && target_->Untrack(slot)) slot->Fail();
+  }
+
+  template <typename Callback>
+  napi_status NonBlockingCall(Callback callback) const {
+    std::shared_ptr<TsfnTarget> target = target_;
+    return tsfn_.NonBlockingCall(
+        [target, callback](Napi::Env env, Napi::Function) mutable {
+          callback(env, Target(env, *target));
+        });
+  }
+
+  // Must be called on the thread of the env.
+  void Lease() {
+    leases_.fetch_add(1, std::memory_order_relaxed);
+    if (active_) return;
+    active_ = true;
+    tsfn_.Ref(env_);
+    napi_reference_ref(env_, target_->ref, nullptr);
+  }
+
+  // Can be called on any thread. The last lease lets the handle go idle on
+  // the thread of the env. A worker waits for room in a bounded queue rather
+  // than leaves the handle active, and so the loop alive, for good.
+  void Unlease() {
+    if (leases_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (OnMainThread()) {
+      Idle();
+      return;
     }
+    std::shared_ptr<TsfnHandle> self = shared_from_this();
+    // It fails only once the env is torn down, which closes the handle.
+    BlockingCall([self](Napi::Env env, Napi::Function) { self->Idle(); });
+  }
 
-    // tsfn를 소유하지 않은 객체를 대입 복사하는것을 차단합니다.
-    if (!rhs.ptsfn_) {
-#ifdef CXX_EXCEPTIONS
-      throw std::runtime_error("invalid object");
-      #endif
-      return *this;
+ private:
+  static Napi::Function Target(napi_env env, const TsfnTarget& target) {
+    napi_value value = nullptr;
+    if (target.ref) napi_get_reference_value(env, target.ref, &value);
+    return Napi::Function(env, value);
+  }
+
+  // A lease may be taken again before this runs.
+  void Idle() {
+    if (!active_ || target_->closed ||
+        leases_.load(std::memory_order_acquire) != 0) {
+      return;
     }
+    active_ = false;
+    tsfn_.Unref(env_);
+    napi_reference_unref(env_, target_->ref, nullptr);
+  }
 
-    // 이미 같은 tfsn을 공유하는 경우 아무 작업을 하지 않도록 합니다.
-    if (tsfn_mtx_ && tsfn_mtx_ == rhs.tsfn_mtx_)
-      return *this;
+  napi_env env_;
+  Napi::ThreadSafeFunction tsfn_;
+  std::shared_ptr<TsfnTarget> target_;
+  size_t max_queue_size_;
+  std::atomic<size_t> leases_;
+  // Touched only on the thread of the env.
+  bool active_;
+  std::thread::id main_thread_;
+};
+
+// A lease of a TsfnHandle, which the copies of a
+// node_binding::thread_safe_function share.
+class TsfnLease {
+ public:
+  // Must be called on the thread of the env.
+  explicit TsfnLease(std::shared_ptr<TsfnHandle> handle)
+      : handle_(std::move(handle)) {
+    handle_->Lease();
+  }
+
+  ~TsfnLease() { handle_->Unlease(); }
 
-    // function객체를 복사합니다.
-    *static_cast<T*>(this) = static_cast<const T&>(rhs);
+  TsfnLease(const TsfnLease&) = delete;
+  TsfnLease& operator=(const TsfnLease&) = delete;
+
+  const std::shared_ptr<TsfnHandle>& handle() const { return handle_; }
+
+ private:
+  std::shared_ptr<TsfnHandle> handle_;
+};
+
+// Caches the thread safe functions of an env by the identity of their JS
+// functions, so that a handler which is given to native code again and again
+// reuses one thread safe function rather than creates one per call. The
+// handles of a function are held by a WeakMap, and are released once the
+// function is collected.
+class TsfnCache {
+ public:
+  explicit TsfnCache(napi_env env) : created_(0) {
+    Napi::Object map = Napi::Env(env)
+                           .Global()
+                           .Get("WeakMap")
+                           .As<Napi::Function>()
+                           .New({});
+    get_ = Napi::Persistent(map.Get("get").As<Napi::Function>());
+    set_ = Napi::Persistent(map.Get("set").As<Napi::Function>());
+    map_ = Napi::Persistent(map);
+  }
 
-    ptsfn_ = std::move(rhs.ptsfn_);  // tfsn을 이 객체로 이동합니다.
-    if (rhs.tsfn_mtx_) {
-      tsfn_mtx_ = rhs.tsfn_mtx_;
+  // Must be called on the thread of the env. A function has a handle per
+  // queue size.
+  static std::shared_ptr<TsfnHandle> Get(const Napi::Function& fn,
+                                         size_t max_queue_size) {
+    return EnvLocal<TsfnCache>::Get(fn.Env()).Find(fn, max_queue_size);
+  }
+
+  // The number of handles which are created in |env| so far.
+  static size_t Created(napi_env env) {
+    return EnvLocal<TsfnCache>::Get(env).created_;
+  }
+
+ private:
+  using Entry = std::vector<std::shared_ptr<TsfnHandle>>;
+
+  std::shared_ptr<TsfnHandle> Find(const Napi::Function& fn,
+                                   size_t max_queue_size) {
+    Napi::Value found = get_.Call(map_.Value(), {fn});
+    Entry* entry;
+    if (found.IsExternal()) {
+      entry = found.As<Napi::External<Entry>>().Data();
     } else {
-      tsfn_mtx_ = std::make_shared<std::shared_timed_mutex>();
-      rhs.tsfn_mtx_ = tsfn_mtx_;
+      entry = new Entry();
+      set_.Call(map_.Value(),
+                {fn, Napi::External<Entry>::New(
+                         fn.Env(), entry,
+                         [](Napi::Env env, Entry* entry) { delete entry; })});
     }
-    tsfn_mtx_->lock_shared();  // 참조를 증가시킵니다.
-    return *this;
+    for (const std::shared_ptr<TsfnHandle>& handle : *entry) {
+      if (handle->max_queue_size() == max_queue_size) return handle;
+    }
+    entry->push_back(std::make_shared<TsfnHandle>(fn, max_queue_size));
+    ++created_;
+    return entry->back();
   }
 
+  Napi::ObjectReference map_;
+  Napi::FunctionReference get_;
+  Napi::FunctionReference set_;
+  size_t created_;
+};
+
+// Holds the calls of a thread safe function with a tsfn_queue which drops
+// calls. The thread safe function is signaled once per batch of calls, and
+// the batch is run in a row on the thread of the env.
+template <typename... Args>
+class DroppingQueue
+    : public std::enable_shared_from_this<DroppingQueue<Args...>> {
  public:
-  void release() {
-    if (ptsfn_) {
-      if (tsfn_mtx_) {
-        tsfn_mtx_->lock();  // 모든 참조가 해제될때까지 대기합니다.
-        tsfn_mtx_->unlock();
-        tsfn_mtx_ = nullptr;
-      }
-      ptsfn_->Release();  // 모든 참조가 해제되었으므로 tsfn을 해제합니다.
-      ptsfn_ = nullptr;
-    } else {
-      if (tsfn_mtx_) {
-        tsfn_mtx_->unlock_shared();  // 참조를 감소시킵니다.
-        tsfn_mtx_ = nullptr;
-      }
+  using Call = std::tuple<std::decay_t<Args>...>;
+
+  explicit DroppingQueue(size_t max_size)
+      : max_size_(max_size), signaled_(false) {}
+
+  void Push(const TsfnHandle& handle, Call call) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (calls_.size() >= max_size_) calls_.pop_front();
+      calls_.push_back(std::move(call));
+      if (signaled_) return;
+      signaled_ = true;
+    }
+    std::shared_ptr<DroppingQueue> self = this->shared_from_this();
+    if (handle.NonBlockingCall([self](Napi::Env env, Napi::Function fn) {
+          self->Drain(fn);
+        }) != napi_ok) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      signaled_ = false;
+    }
+  }
+
+ private:
+  void Drain(const Napi::Function& fn) {
+    std::deque<Call> calls;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      calls.swap(calls_);
+      signaled_ = false;
+    }
+    for (Call& call : calls) {
+      JsCall<void>::Run(fn, std::index_sequence_for<Args...>(), call);
+    }
+  }
+
+  size_t max_size_;
+  bool signaled_;
+  std::deque<Call> calls_;
+  std::mutex mutex_;
+};
+
+// The value is constructed in place only once the call is made, so R needs
+// neither a default constructor nor an assignment.
+template <typename R>
+class ReplySlot : public ReplySlotBase {
+ public:
+  ReplySlot() {}
+
+  ~ReplySlot() {
+    if (ok_) value().~R();
+  }
+
+  // Sets the reply to the result of |fn|.
+  template <typename Fn>
+  void Run(Fn&& fn) {
+    new (&storage_) R(fn());
+    ok_ = true;
+    Publish();
+  }
+
+  // A failed call returns R() if R has a default constructor and C++
+  // exceptions are disabled.
+  R Take() {
+    Wait();
+    if (!ok_) return Failed(std::is_default_constructible<R>());
+    return std::move(value());
+  }
+
+ private:
+  R& value() { return *reinterpret_cast<R*>(&storage_); }
+
+  static R Failed(std::true_type) {
+#ifdef CXX_EXCEPTIONS
+    ThrowFailed();
+#endif
+    return R();
+  }
+
+  static R Failed(std::false_type) {
+    ThrowFailed();
+    abort();
+  }
+
+  std::aligned_storage_t<sizeof(R), alignof(R)> storage_;
+};
+
+template <>
+class ReplySlot<void> : public ReplySlotBase {
+ public:
+  template <typename Fn>
+  void Run(Fn&& fn) {
+    fn();
+    ok_ = true;
+    Publish();
+  }
+
+  void Take() {
+    Wait();
+#ifdef CXX_EXCEPTIONS
+    if (!ok_) ThrowFailed();
+#endif
+  }
+};
+
+}  // namespace internal
+
+/**
+ * @brief The reply of node_binding::thread_safe_function::async_call(),
+ * which a worker collects later.
+ *
+ * @tparam R
+ */
+template <typename R>
+class reply {
+ public:
+  reply() {}
+  explicit reply(std::shared_ptr<internal::ReplySlot<R>> slot)
+      : slot_(std::move(slot)) {}
+
+  bool valid() const { return slot_ != nullptr; }
+  bool ready() const { return slot_->ready(); }
+  void wait() const { slot_->Wait(); }
+
+  // Waits for the reply, and returns whether the call is made. It fails if
+  // the thread safe function is closed, e.g. by the teardown of the env,
+  // before the call is run, even if the call is already queued.
+  bool ok() const {
+    slot_->Wait();
+    return slot_->ok();
+  }
+
+  // Waits for the reply and takes it. Must be called once. A failed call
+  // throws std::runtime_error; without C++ exceptions, check ok() first.
+  R get() { return slot_->Take(); }
+
+ private:
+  std::shared_ptr<internal::ReplySlot<R>> slot_;
+};
+
+/**
+ * @brief node_binding::thread_safe_function<function<?>>
+ *
+ * A JS function which native threads can call. A call on a worker blocks
+ * until it is done on the thread of the env. async_call() returns a reply
+ * right away instead, so a worker can have many calls in flight and
+ * collect their replies later, and the thread of the env runs them in a
+ * row rather than a round trip at a time.
+ *
+ * @code
+ * std::vector<node_binding::reply<bool>> replies;
+ * for (const Item& item : items) replies.push_back(accept.async_call(item));
+ * for (size_t i = 0; i < items.size(); ++i) {
+ *   if (replies[i].get()) Process(items[i]);
+ * }
+ * @endcode
+ *
+ * Copies share a lease of the thread safe function, which ends with the last
+ * copy or by release() of each copy. The thread safe function itself is
+ * cached per JS function, so the same function which is given again reuses
+ * it rather than creates another one.
+ *
+ * Calls of workers are queued by |Policy|, one of node_binding::tsfn_queue.
+ *
+ * @code
+ * void Export(std::string path,
+ *             thread_safe_function<void(double), tsfn_queue::coalesce_latest>
+ *                 progress);
+ * @endcode
+ *
+ * @tparam T
+ * @tparam Policy
+ */
+template <typename Fty_, typename Policy = tsfn_queue::unbounded>
+class thread_safe_function : public std::function<Fty_> {
+  using T = std::function<Fty_>;
+  using R = typename internal::FunctionTraits<T>::ReturnType;
+
+ public:
+  thread_safe_function() {}
+
+  thread_safe_function(T fn) : T(fn) {}
+
+  thread_safe_function(std::shared_ptr<internal::TsfnLease> lease, T fn)
+      : T(fn), lease_(std::move(lease)) {}
+
+  thread_safe_function(const thread_safe_function& other) = default;
+
+  thread_safe_function& operator=(const thread_safe_function& rhs) {
+    // 스레드 안전 함수를 소유하지 않은 객체를 대입 복사하는것을 차단합니다.
+    if (!rhs.lease_) {
+#ifdef CXX_EXCEPTIONS
+      throw std::runtime_error("invalid object");
+#endif
+      return *this;
     }
+    static_cast<T&>(*this) = static_cast<const T&>(rhs);
+    lease_ = rhs.lease_;
+    return *this;
   }
 
+  // Calls the function without waiting for it, and returns its reply. It
+  // blocks only while a bounded queue is full.
+  template <typename... CallArgs>
+  reply<R> async_call(CallArgs&&... args) const {
+    static_assert(!Policy::kDrops,
+                  "A call whose reply is awaited must not be dropped");
+    std::shared_ptr<internal::ReplySlot<R>> slot =
+        std::make_shared<internal::ReplySlot<R>>();
+    if (!lease_ || lease_->handle()->OnMainThread()) {
+      slot->Run([&]() -> R { return (*this)(args...); });
+      return reply<R>(slot);
+    }
+
+    std::tuple<std::decay_t<CallArgs>...> call_args(
+        std::forward<CallArgs>(args)...);
+    lease_->handle()->CallForReply(
+        slot.get(),
+        [slot, call_args](Napi::Env env, Napi::Function fn) mutable {
+          slot->Run([&]() -> R {
+            return internal::JsCall<R>::Run(
+                fn, std::index_sequence_for<CallArgs...>(), call_args);
+          });
+        });
+    return reply<R>(slot);
+  }
+
+  // Drops the lease of this copy.
+  void release() { lease_ = nullptr; }
+
  private:
-  mutable std::unique_ptr<Napi::ThreadSafeFunction> ptsfn_;
-  mutable std::shared_ptr<std::shared_timed_mutex> tsfn_mtx_;
-  mutable std::mutex copy_op_mtx_;
+  std::shared_ptr<internal::TsfnLease> lease_;
 };
 
 /**
@@ -220,31 +767,42 @@ class thread_safe_function : public std::function<Fty_> {
  * Napi::ThreadSafeFunction
  *
  * @tparam Args
+ * @tparam Policy
  */
-template <typename... Args>
-class TypeConvertor<thread_safe_function<void(Args...)>> {
+template <typename... Args, typename Policy>
+class TypeConvertor<thread_safe_function<void(Args...), Policy>> {
  public:
-  static thread_safe_function<void(Args...)> ToNativeValue(
+  static thread_safe_function<void(Args...), Policy> ToNativeValue(
       const Napi::Value& value) {
-    Napi::Function fn = value.As<Napi::Function>();
-    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-        value.Env(), fn, "thread safe function resource", 0, 1);
-    // 메인 스레드의 식별자를 저장합니다.
-    //  - ToNativeValue 메서드는 메인 스레드에서 호출되는것을 전제 조건으로
-    //  합니다.
-    std::thread::id tid = std::this_thread::get_id();
-    return thread_safe_function<void(Args...)>(
-        tsfn, [tid, fn, tsfn](Args... args) {
+    // A dropping queue signals the thread safe function once per batch, so
+    // its own queue never grows.
+    std::shared_ptr<internal::TsfnHandle> handle = internal::TsfnCache::Get(
+        value.As<Napi::Function>(), Policy::kDrops ? 0 : Policy::kMaxSize);
+    std::shared_ptr<internal::DroppingQueue<Args...>> queue;
+    if (Policy::kDrops) {
+      size_t max_size = Policy::kMaxSize;
+      queue = std::make_shared<internal::DroppingQueue<Args...>>(max_size);
+    }
+    return thread_safe_function<void(Args...), Policy>(
+        std::make_shared<internal::TsfnLease>(handle),
+        [handle, queue](Args... args) {
           // 메인 스레드가 호출했다면 Napi::Function을 직접 호출합니다.
-          if (std::this_thread::get_id() == tid) {
-            Invoke(fn, std::make_index_sequence<sizeof...(Args)>{},
-                   std::forward_as_tuple(args...));
+          if (handle->OnMainThread()) {
+            std::tuple<Args&...> call_args(args...);
+            internal::JsCall<void>::Run(handle->Target(),
+                                        std::index_sequence_for<Args...>(),
+                                        call_args);
             return;
           }
 
-          tsfn.BlockingCall([args...](Napi::Env env, Napi::Function fn) {
-            Invoke(fn, std::make_index_sequence<sizeof...(Args)>{},
-                   std::forward_as_tuple(args...));
+          if (queue) {
+            queue->Push(*handle, std::make_tuple(args...));
+            return;
+          }
+          handle->BlockingCall([args...](Napi::Env env, Napi::Function fn) {
+            std::tuple<const Args&...> call_args(args...);
+            internal::JsCall<void>::Run(
+                fn, std::index_sequence_for<Args...>(), call_args);
           });
         });
   }
@@ -260,37 +818,43 @@ class TypeConvertor<thread_safe_function<void(Args...)>> {
  *
  * @tparam R
  * @tparam Args
+ * @tparam Policy
  */
-template <typename R, typename... Args>
-class TypeConvertor<thread_safe_function<R(Args...)>> {
+template <typename R, typename... Args, typename Policy>
+class TypeConvertor<thread_safe_function<R(Args...), Policy>> {
+  static_assert(!Policy::kDrops,
+                "A call whose result is awaited must not be dropped");
+
  public:
-  static thread_safe_function<R(Args...)> ToNativeValue(
+  static thread_safe_function<R(Args...), Policy> ToNativeValue(
       const Napi::Value& value) {
-    Napi::Function fn = value.As<Napi::Function>();
-    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
-        value.Env(), fn, "thread safe function resource", 0, 1);
-    // 메인 스레드의 식별자를 저장합니다.
-    //  - ToNativeValue 메서드는 메인 스레드에서 호출되는것을 전제 조건으로
-    //  합니다.
-    std::thread::id tid = std::this_thread::get_id();
-    return thread_safe_function<R(Args...)>(
-        tsfn, [tid, fn, tsfn](Args... args) -> R {
+    std::shared_ptr<internal::TsfnHandle> handle = internal::TsfnCache::Get(
+        value.As<Napi::Function>(), Policy::kMaxSize);
+    return thread_safe_function<R(Args...), Policy>(
+        std::make_shared<internal::TsfnLease>(handle),
+        [handle](Args... args) -> R {
           // 메인 스레드가 호출했다면 Napi::Function을 직접 호출합니다.
-          if (std::this_thread::get_id() == tid) {
-            return Invoke<R>(fn, std::make_index_sequence<sizeof...(Args)>{},
-                             std::forward_as_tuple(args...));
+          if (handle->OnMainThread()) {
+            std::tuple<Args&...> call_args(args...);
+            return internal::JsCall<R>::Run(
+                handle->Target(), std::index_sequence_for<Args...>(),
+                call_args);
           }
 
-          std::promise<R> p;
-          napi_status status = tsfn.BlockingCall(
-              [&p, args...](Napi::Env env, Napi::Function fn) {
-                p.set_value(
-                    Invoke<R>(fn, std::make_index_sequence<sizeof...(Args)>{},
-                              std::forward_as_tuple(args...)));
+          // The call blocks until it is done, so its reply lives on the
+          // stack.
+          internal::ReplySlot<R> slot;
+          handle->CallForReply(
+              &slot, [&slot, args...](Napi::Env env, Napi::Function fn) {
+                slot.Run([&] {
+                  std::tuple<const Args&...> call_args(args...);
+                  return internal::JsCall<R>::Run(
+                      fn, std::index_sequence_for<Args...>(), call_args);
+                });
               });
-          if (status != napi_ok)
-            return R();
-          return p.get_future().get();
+          slot.Wait();
+          if (!slot.ok()) return R();
+          return slot.Take();
         });
   }
 
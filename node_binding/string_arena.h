@@ -0,0 +1,118 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_STRING_ARENA_H_
+#define NODE_BINDING_STRING_ARENA_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace node_binding {
+namespace internal {
+
+/**
+ * @brief Per-thread growable buffer which backs std::string_view and
+ * const char* arguments.
+ *
+ * Memory is handed out by bumping an offset and is given back all at once
+ * when the enclosing StringArenaScope ends, so the chunks are reused by the
+ * next call without touching the heap. Chunks never move, so a view stays
+ * valid even if the arena grows afterwards.
+ */
+class StringArena {
+ public:
+  struct Mark {
+    size_t chunk;
+    size_t offset;
+  };
+
+  static StringArena& Get() {
+    thread_local StringArena arena;
+    return arena;
+  }
+
+  Mark GetMark() const { return {chunk_, offset_}; }
+
+  void Reset(const Mark& mark) {
+    chunk_ = mark.chunk;
+    offset_ = mark.offset;
+  }
+
+  // Returns a buffer of at least |size| bytes. Nothing is consumed until
+  // Commit() is called, so a reservation which turns out to be too small can
+  // be simply abandoned.
+  char* Reserve(size_t size) {
+    // Outside of any scope, a view is valid until the next conversion on the
+    // same thread.
+    if (depth_ == 0) Reset({0, 0});
+
+    while (chunk_ < chunks_.size()) {
+      Chunk& chunk = chunks_[chunk_];
+      if (chunk.capacity - offset_ >= size) return chunk.data.get() + offset_;
+      ++chunk_;
+      offset_ = 0;
+    }
+
+    size_t capacity = chunks_.empty() ? kMinChunkSize
+                                      : chunks_.back().capacity * 2;
+    capacity = std::max(capacity, size);
+    chunks_.push_back({std::unique_ptr<char[]>(new char[capacity]), capacity});
+    chunk_ = chunks_.size() - 1;
+    offset_ = 0;
+    return chunks_.back().data.get();
+  }
+
+  void Commit(size_t size) { offset_ += size; }
+
+  void Enter() { ++depth_; }
+  void Leave() { --depth_; }
+
+ private:
+  static constexpr size_t kMinChunkSize = 4096;
+
+  struct Chunk {
+    std::unique_ptr<char[]> data;
+    size_t capacity;
+  };
+
+  StringArena() : chunk_(0), offset_(0), depth_(0) {}
+
+  std::vector<Chunk> chunks_;
+  size_t chunk_;
+  size_t offset_;
+  size_t depth_;
+};
+
+/**
+ * @brief Gives back everything which is allocated from the StringArena
+ * during its lifetime. It is placed around every bound native call, so views
+ * into the arena live exactly as long as the call.
+ */
+class StringArenaScope {
+ public:
+  StringArenaScope()
+      : arena_(StringArena::Get()), mark_(arena_.GetMark()) {
+    arena_.Enter();
+  }
+
+  ~StringArenaScope() {
+    arena_.Leave();
+    arena_.Reset(mark_);
+  }
+
+  StringArenaScope(const StringArenaScope&) = delete;
+  StringArenaScope& operator=(const StringArenaScope&) = delete;
+
+ private:
+  StringArena& arena_;
+  StringArena::Mark mark_;
+};
+
+}  // namespace internal
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_STRING_ARENA_H_
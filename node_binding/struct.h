@@ -0,0 +1,322 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_STRUCT_H_
+#define NODE_BINDING_STRUCT_H_
+
+#include <stddef.h>
+
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/property_key.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+/**
+ * @brief Field list of a struct. Don't specialize it by hand, use
+ * NODE_BINDING_STRUCT() instead.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct StructFields;
+
+namespace internal {
+
+template <typename T, typename M>
+struct StructField {
+  using Type = M;
+
+  const char* name;
+  M T::*member;
+};
+
+template <typename T, typename M>
+constexpr StructField<T, M> MakeStructField(const char* name, M T::*member) {
+  return {name, member};
+}
+
+template <typename T, size_t I>
+const property_key& StructKey() {
+  static const property_key key(std::get<I>(StructFields<T>::Get()).name);
+  return key;
+}
+
+/**
+ * @brief TypeConvertor of a struct which is declared with
+ * NODE_BINDING_STRUCT().
+ *
+ * Each field is looked up once by its interned key and is checked and
+ * converted in the same pass. A JS object is created with all properties
+ * defined by a single napi_define_properties() call in declaration order, so
+ * every object of T shares the same hidden class.
+ *
+ * @tparam T has to be default constructible.
+ */
+template <typename T>
+class StructConvertor {
+  using Fields = decltype(StructFields<T>::Get());
+  static constexpr size_t kNumFields = std::tuple_size<Fields>::value;
+  using Indices = std::make_index_sequence<kNumFields>;
+
+  template <size_t I>
+  using FieldType = typename std::tuple_element_t<I, Fields>::Type;
+
+  static_assert(std::is_default_constructible<T>::value,
+                "NODE_BINDING_STRUCT() requires T to be default "
+                "constructible.");
+
+ public:
+  static bool TryToNativeValue(const Napi::Value& value, T* out) {
+    if (!value.IsObject()) return false;
+    return ExtractFields(value.Env(), value, out, Indices());
+  }
+
+  static T ToNativeValue(const Napi::Value& value) {
+    T ret{};
+    TryToNativeValue(value, &ret);
+    return ret;
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    if (!value.IsObject()) return false;
+    return CheckFields(value.Env(), value, Indices());
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env, const T& value) {
+    return NewObject(env, value, Indices());
+  }
+
+ private:
+  template <size_t I>
+  static bool GetField(napi_env env, PropertyKeys* keys, napi_value obj,
+                       Napi::Value* field) {
+    const property_key& key = StructKey<T, I>();
+    napi_value ret;
+    if (napi_get_property(env, obj, keys->Get(key.id(), key.name()), &ret) !=
+        napi_ok)
+      return false;
+    *field = Napi::Value(env, ret);
+    return true;
+  }
+
+  template <size_t I>
+  static bool ExtractField(napi_env env, PropertyKeys* keys, napi_value obj,
+                           T* out) {
+    Napi::Value field;
+    return GetField<I>(env, keys, obj, &field) &&
+           internal::TryToNativeValue<FieldType<I>>(
+               field, &(out->*(std::get<I>(StructFields<T>::Get()).member)));
+  }
+
+  template <size_t I>
+  static bool CheckField(napi_env env, PropertyKeys* keys, napi_value obj) {
+    Napi::Value field;
+    return GetField<I>(env, keys, obj, &field) &&
+           TypeConvertor<FieldType<I>>::IsConvertible(field);
+  }
+
+  template <size_t... Is>
+  static bool ExtractFields(napi_env env, napi_value obj, T* out,
+                            std::index_sequence<Is...>) {
+    PropertyKeys keys(env);
+    bool ret = true;
+    (void)std::initializer_list<int>{
+        (ret = ret && ExtractField<Is>(env, &keys, obj, out), 0)...};
+    return ret;
+  }
+
+  template <size_t... Is>
+  static bool CheckFields(napi_env env, napi_value obj,
+                          std::index_sequence<Is...>) {
+    PropertyKeys keys(env);
+    bool ret = true;
+    (void)std::initializer_list<int>{
+        (ret = ret && CheckField<Is>(env, &keys, obj), 0)...};
+    return ret;
+  }
+
+  template <size_t... Is>
+  static Napi::Value NewObject(const Napi::Env& env, const T& value,
+                               std::index_sequence<Is...>) {
+    napi_value obj;
+    if (napi_create_object(env, &obj) != napi_ok) return Napi::Value();
+
+    constexpr napi_property_attributes kAttributes =
+        static_cast<napi_property_attributes>(napi_writable | napi_enumerable |
+                                              napi_configurable);
+    PropertyKeys keys(env);
+    napi_property_descriptor descriptors[] = {
+        {nullptr,
+         keys.Get(StructKey<T, Is>().id(), StructKey<T, Is>().name()),
+         nullptr, nullptr, nullptr,
+         TypeConvertor<FieldType<Is>>::ToJSValue(
+             env, value.*(std::get<Is>(StructFields<T>::Get()).member)),
+         kAttributes, nullptr}...};
+    if (napi_define_properties(env, obj, kNumFields, descriptors) != napi_ok)
+      return Napi::Value();
+    return Napi::Value(env, obj);
+  }
+};
+
+}  // namespace internal
+}  // namespace node_binding
+
+// MSVC passes __VA_ARGS__ as a single argument unless it is expanded again.
+#define NODE_BINDING_EXPAND(x) x
+
+#define NODE_BINDING_STRUCT_FIELD(Type, field) \
+  ::node_binding::internal::MakeStructField(#field, &Type::field)
+
+#define NODE_BINDING_STRUCT_FIELDS_1(Type, f) NODE_BINDING_STRUCT_FIELD(Type, f)
+#define NODE_BINDING_STRUCT_FIELDS_2(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_1(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_3(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_2(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_4(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_3(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_5(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_4(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_6(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_5(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_7(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_6(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_8(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_7(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_9(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),              \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_8(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_10(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_9(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_11(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_10(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_12(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_11(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_13(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_12(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_14(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_13(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_15(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_14(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_16(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_15(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_17(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_16(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_18(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_17(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_19(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_18(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_20(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_19(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_21(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_20(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_22(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_21(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_23(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_22(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_24(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_23(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_25(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_24(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_26(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_25(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_27(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_26(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_28(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_27(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_29(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_28(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_30(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_29(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_31(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_30(Type, __VA_ARGS__))
+#define NODE_BINDING_STRUCT_FIELDS_32(Type, f, ...) \
+  NODE_BINDING_STRUCT_FIELD(Type, f),               \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_FIELDS_31(Type, __VA_ARGS__))
+
+#define NODE_BINDING_STRUCT_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, \
+    _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, \
+    _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...) NAME
+
+#define NODE_BINDING_STRUCT_FIELDS(Type, ...)                       \
+  NODE_BINDING_EXPAND(NODE_BINDING_STRUCT_PICK(                     \
+      __VA_ARGS__, NODE_BINDING_STRUCT_FIELDS_32,                   \
+      NODE_BINDING_STRUCT_FIELDS_31, NODE_BINDING_STRUCT_FIELDS_30, \
+      NODE_BINDING_STRUCT_FIELDS_29, NODE_BINDING_STRUCT_FIELDS_28, \
+      NODE_BINDING_STRUCT_FIELDS_27, NODE_BINDING_STRUCT_FIELDS_26, \
+      NODE_BINDING_STRUCT_FIELDS_25, NODE_BINDING_STRUCT_FIELDS_24, \
+      NODE_BINDING_STRUCT_FIELDS_23, NODE_BINDING_STRUCT_FIELDS_22, \
+      NODE_BINDING_STRUCT_FIELDS_21, NODE_BINDING_STRUCT_FIELDS_20, \
+      NODE_BINDING_STRUCT_FIELDS_19, NODE_BINDING_STRUCT_FIELDS_18, \
+      NODE_BINDING_STRUCT_FIELDS_17, NODE_BINDING_STRUCT_FIELDS_16, \
+      NODE_BINDING_STRUCT_FIELDS_15, NODE_BINDING_STRUCT_FIELDS_14, \
+      NODE_BINDING_STRUCT_FIELDS_13, NODE_BINDING_STRUCT_FIELDS_12, \
+      NODE_BINDING_STRUCT_FIELDS_11, NODE_BINDING_STRUCT_FIELDS_10, \
+      NODE_BINDING_STRUCT_FIELDS_9, NODE_BINDING_STRUCT_FIELDS_8,   \
+      NODE_BINDING_STRUCT_FIELDS_7, NODE_BINDING_STRUCT_FIELDS_6,   \
+      NODE_BINDING_STRUCT_FIELDS_5, NODE_BINDING_STRUCT_FIELDS_4,   \
+      NODE_BINDING_STRUCT_FIELDS_3, NODE_BINDING_STRUCT_FIELDS_2,   \
+      NODE_BINDING_STRUCT_FIELDS_1)(Type, __VA_ARGS__))
+
+/**
+ * @brief Generates TypeConvertor<Type> from the list of its fields. Up to 32
+ * fields are supported. It has to be used in the global namespace.
+ *
+ * @code
+ * struct Size {
+ *   int width;
+ *   int height;
+ * };
+ *
+ * NODE_BINDING_STRUCT(Size, width, height)
+ * @endcode
+ */
+#define NODE_BINDING_STRUCT(Type, ...)                                       \
+  namespace node_binding {                                                   \
+  template <>                                                                \
+  struct StructFields<Type> {                                                \
+    static auto Get() {                                                      \
+      return std::make_tuple(NODE_BINDING_STRUCT_FIELDS(Type, __VA_ARGS__)); \
+    }                                                                        \
+  };                                                                         \
+                                                                             \
+  template <>                                                                \
+  class TypeConvertor<Type> : public internal::StructConvertor<Type> {};     \
+  }
+
+#endif  // NODE_BINDING_STRUCT_H_
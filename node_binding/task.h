@@ -0,0 +1,394 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_TASK_H_
+#define NODE_BINDING_TASK_H_
+
+#include "node_binding/build_config.h"
+
+#if CXX_VER >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "napi.h"
+#include "node_binding/completion_queue.h"
+#include "node_binding/promise.h"
+#include "node_binding/thread_pool.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+template <typename T = void>
+class task;
+
+#ifdef CXX_EXCEPTIONS
+// Thrown by co_await of a js_promise which is rejected.
+class promise_rejection : public std::runtime_error {
+ public:
+  explicit promise_rejection(const std::string& what)
+      : std::runtime_error(what) {}
+};
+#endif
+
+namespace internal {
+
+class TaskPromiseBase {
+ public:
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      TaskPromiseBase& promise = handle.promise();
+      if (promise.continuation) return promise.continuation;
+      // |done| may destroy the coroutine, and |promise| with it.
+      std::function<void()> done = std::move(promise.on_done);
+      if (done) done();
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() {
+#ifdef CXX_EXCEPTIONS
+    exception = std::current_exception();
+#else
+    std::terminate();
+#endif
+  }
+
+  void RethrowIfFailed() {
+#ifdef CXX_EXCEPTIONS
+    if (exception) std::rethrow_exception(exception);
+#endif
+  }
+
+  // Returns the message of the exception which the task ended with.
+  bool Failed(std::string* what) {
+#ifdef CXX_EXCEPTIONS
+    if (!exception) return false;
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      *what = e.what();
+    } catch (...) {
+      *what = "unknown exception";
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // The queue of the env which the task is started on. The tasks which it
+  // awaits share it.
+  std::shared_ptr<completion_queue> queue;
+  // The task which awaits this one, if any.
+  std::coroutine_handle<> continuation;
+  // Called when a task which nobody awaits is done.
+  std::function<void()> on_done;
+  std::exception_ptr exception;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  task<T> get_return_object() {
+    return task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+  }
+
+  template <typename U>
+  void return_value(U&& value) {
+    result.emplace(std::forward<U>(value));
+  }
+
+  T TakeResult() {
+    RethrowIfFailed();
+    return std::move(*result);
+  }
+
+  std::optional<T> result;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  task<void> get_return_object();
+
+  void return_void() {}
+
+  void TakeResult() { RethrowIfFailed(); }
+};
+
+// Returns the completion which settles |deferred| by the result of
+// |promise|.
+template <typename T>
+std::function<void(Napi::Env)> TaskCompletion(
+    TaskPromise<T>& promise, const Napi::Promise::Deferred& deferred) {
+  std::string what;
+  if (promise.Failed(&what)) {
+    return [deferred, what](Napi::Env env) {
+      RejectWithNativeError(env, deferred, what);
+    };
+  }
+  std::shared_ptr<T> result = std::make_shared<T>(std::move(*promise.result));
+  return [deferred, result](Napi::Env env) {
+    deferred.Resolve(node_binding::ToJSValue(env, *result));
+  };
+}
+
+inline std::function<void(Napi::Env)> TaskCompletion(
+    TaskPromise<void>& promise, const Napi::Promise::Deferred& deferred) {
+  std::string what;
+  if (promise.Failed(&what)) {
+    return [deferred, what](Napi::Env env) {
+      RejectWithNativeError(env, deferred, what);
+    };
+  }
+  return [deferred](Napi::Env env) { deferred.Resolve(env.Undefined()); };
+}
+
+}  // namespace internal
+
+/**
+ * @brief A coroutine which is returned to JS as a Promise.
+ *
+ * A bound function which returns task<T> returns a Promise, which is settled
+ * by co_return or by an exception. The task starts on the thread of the env
+ * and can move between threads by co_await on_pool() and co_await
+ * on_main(), so each stage of a pipeline holds a thread only while it runs.
+ * It can also co_await another task or a js_promise on the thread of the
+ * env. Its arguments are used after the call returns, so they have to own
+ * what they hold, e.g. std::string rather than const char*.
+ *
+ * @code
+ * task<int> Count(std::string path) {
+ *   co_await on_pool();
+ *   int lines = CountLines(path);
+ *   co_await on_main();
+ *   co_return lines;
+ * }
+ * @endcode
+ *
+ * @tparam T
+ */
+template <typename T>
+class task {
+ public:
+  using promise_type = internal::TaskPromise<T>;
+
+  explicit task(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  task& operator=(task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  ~task() {
+    if (handle_) handle_.destroy();
+  }
+
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+
+ private:
+  struct Awaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> awaiting) noexcept {
+      handle.promise().continuation = awaiting;
+      handle.promise().queue = awaiting.promise().queue;
+      return handle;
+    }
+
+    T await_resume() { return handle.promise().TakeResult(); }
+
+    std::coroutine_handle<promise_type> handle;
+  };
+
+ public:
+  // Starts the task, and resumes the awaiting one once it is done.
+  Awaiter operator co_await() && noexcept { return Awaiter{handle_}; }
+
+  // Gives up the ownership of the coroutine.
+  std::coroutine_handle<promise_type> Release() {
+    return std::exchange(handle_, {});
+  }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+inline task<void> internal::TaskPromise<void>::get_return_object() {
+  return task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+/**
+ * @brief Resumes a task on |pool|, or on a pool which tasks share by
+ * default.
+ */
+class on_pool {
+ public:
+  explicit on_pool(std::shared_ptr<thread_pool> pool = nullptr)
+      : pool_(pool ? std::move(pool) : DefaultPool()) {}
+
+  bool await_ready() noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    pool_->Post([handle] { handle.resume(); });
+  }
+
+  void await_resume() noexcept {}
+
+ private:
+  static std::shared_ptr<thread_pool> DefaultPool() {
+    static std::shared_ptr<thread_pool> pool =
+        std::make_shared<thread_pool>();
+    return pool;
+  }
+
+  std::shared_ptr<thread_pool> pool_;
+};
+
+/**
+ * @brief Resumes a task on the thread of the env which it is started on.
+ */
+class on_main {
+ public:
+  bool await_ready() noexcept { return false; }
+
+  template <typename Promise>
+  void await_suspend(std::coroutine_handle<Promise> handle) {
+    std::shared_ptr<completion_queue> queue = handle.promise().queue;
+    queue->Push([queue, handle](Napi::Env env) {
+      // Every completion drops a reference of the queue, but the task still
+      // holds its own until it is done.
+      queue->Ref();
+      handle.resume();
+    });
+  }
+
+  void await_resume() noexcept {}
+};
+
+/**
+ * @brief Awaits a JS Promise, or any value, and resumes with it converted
+ * into T.
+ *
+ * It has to be awaited on the thread of the env. The task is resumed in the
+ * reaction of the promise, so a Napi::Value which it resumes with is valid
+ * only until the task is suspended again. A rejection is thrown as
+ * node_binding::promise_rejection; without C++ exceptions the task resumes
+ * with T() instead.
+ *
+ * @tparam T
+ */
+template <typename T = Napi::Value>
+class js_promise {
+ public:
+  explicit js_promise(const Napi::Value& value) : value_(value) {}
+
+  bool await_ready() noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    Napi::Env env = value_.Env();
+    Napi::Object promise_class =
+        env.Global().Get("Promise").As<Napi::Object>();
+    Napi::Value promise =
+        promise_class.Get("resolve").As<Napi::Function>().Call(promise_class,
+                                                               {value_});
+    Napi::Function on_fulfilled = Napi::Function::New(
+        env, [this, handle](const Napi::CallbackInfo& info) {
+          T result;
+          if (internal::TryToNativeValue<T>(info[0], &result)) {
+            result_.emplace(std::move(result));
+          } else {
+            rejection_ = "Type of the resolved value is mismatched";
+          }
+          handle.resume();
+        });
+    Napi::Function on_rejected = Napi::Function::New(
+        env, [this, handle](const Napi::CallbackInfo& info) {
+          rejection_ = info[0].ToString().Utf8Value();
+          handle.resume();
+        });
+    promise.As<Napi::Object>().Get("then").As<Napi::Function>().Call(
+        promise, {on_fulfilled, on_rejected});
+  }
+
+  T await_resume() {
+#ifdef CXX_EXCEPTIONS
+    if (!result_) throw promise_rejection(rejection_);
+#else
+    if (!result_) return T();
+#endif
+    return std::move(*result_);
+  }
+
+ private:
+  Napi::Value value_;
+  std::optional<T> result_;
+  std::string rejection_;
+};
+
+namespace internal {
+
+template <typename T>
+struct IsDeferredResult<task<T>> : std::true_type {};
+
+}  // namespace internal
+
+/**
+ * @brief node_binding::task<T> --> Promise
+ *
+ * @tparam T
+ */
+template <typename T>
+class TypeConvertor<task<T>> {
+ public:
+  static Napi::Value ToJSValue(const Napi::Env& env, task<T> value) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    std::shared_ptr<completion_queue> queue = completion_queue::Get(env);
+    std::coroutine_handle<internal::TaskPromise<T>> handle = value.Release();
+    // Held until the task is done, so that the loop stays alive while it
+    // runs anywhere.
+    queue->Ref();
+    handle.promise().queue = queue;
+    handle.promise().on_done = [handle, queue, deferred] {
+      std::function<void(Napi::Env)> completion =
+          internal::TaskCompletion(handle.promise(), deferred);
+      handle.destroy();
+      queue->Push(std::move(completion));
+    };
+    handle.resume();
+    return deferred.Promise();
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // CXX_VER >= 202002L && defined(__cpp_impl_coroutine)
+
+#endif  // NODE_BINDING_TASK_H_
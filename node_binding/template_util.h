@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 
+#include <functional>
 #include <type_traits>
 
 namespace node_binding {
@@ -25,11 +26,45 @@ struct PickTypeListItemImpl<n, TypeList<T, List...>>
 template <typename T, typename... List>
 struct PickTypeListItemImpl<0, TypeList<T, List...>> {
   using Type = std::decay_t<T>;
+  using RawType = T;
 };
 
 template <size_t n, typename List>
 using PickTypeListItem = typename PickTypeListItemImpl<n, List>::Type;
 
+template <size_t n, typename List>
+using PickRawTypeListItem = typename PickTypeListItemImpl<n, List>::RawType;
+
+template <typename F>
+struct FunctionTraits;
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...)> {
+  using ReturnType = R;
+  using ArgList = TypeList<Args...>;
+  static constexpr size_t kArity = sizeof...(Args);
+};
+
+template <typename R, typename Class, typename... Args>
+struct FunctionTraits<R (Class::*)(Args...)> : FunctionTraits<R (*)(Args...)> {
+};
+
+template <typename R, typename Class, typename... Args>
+struct FunctionTraits<R (Class::*)(Args...) const>
+    : FunctionTraits<R (*)(Args...)> {};
+
+template <typename R, typename Class, typename... Args>
+struct FunctionTraits<R (Class::*)(Args...) const&>
+    : FunctionTraits<R (*)(Args...)> {};
+
+template <typename R, typename Class, typename... Args>
+struct FunctionTraits<R (Class::*)(Args...) &&>
+    : FunctionTraits<R (*)(Args...)> {};
+
+template <typename R, typename... Args>
+struct FunctionTraits<std::function<R(Args...)>>
+    : FunctionTraits<R (*)(Args...)> {};
+
 }  // namespace internal
 }  // namespace node_binding
 
@@ -0,0 +1,198 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_THREAD_POOL_H_
+#define NODE_BINDING_THREAD_POOL_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace node_binding {
+
+/**
+ * @brief A work-stealing pool of native threads.
+ *
+ * It is an alternative to the libuv threadpool for CPU-bound work, so that
+ * long native jobs don't hold the threads which fs and dns requests need.
+ *
+ * Each worker has its own deque. A task which is posted from a worker goes to
+ * the back of its deque and is taken from there by the same worker; other
+ * tasks are spread over the workers round robin. An idle worker steals from
+ * the front of the others' deques, spins |spin_count| times and then parks
+ * until a task is posted.
+ *
+ * The destructor runs every task which is already posted, then joins the
+ * workers. A task must not throw.
+ */
+class thread_pool {
+ public:
+  using task = std::function<void()>;
+
+  static constexpr size_t kDefaultSpinCount = 64;
+
+  // |num_threads| of 0 means std::thread::hardware_concurrency().
+  explicit thread_pool(size_t num_threads = 0,
+                       size_t spin_count = kDefaultSpinCount)
+      : state_(std::make_shared<State>(spin_count)) {
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 1;
+    state_->workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+      state_->workers.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+      state_->workers[i]->thread = std::thread(&thread_pool::Run, state_, i);
+    }
+  }
+
+  // A task may drop the last reference to the pool, so this may run on one
+  // of its workers. That worker can't join itself; it is detached instead,
+  // and exits by itself once the tasks are done.
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(state_->park_mutex);
+      state_->stopping = true;
+    }
+    state_->park_cv.notify_all();
+    for (auto& worker : state_->workers) {
+      if (worker->thread.get_id() == std::this_thread::get_id()) {
+        worker->thread.detach();
+      } else {
+        worker->thread.join();
+      }
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  size_t size() const { return state_->workers.size(); }
+
+  // Can be called on any thread, including the workers of this pool.
+  void Post(task t) {
+    State& state = *state_;
+    size_t index;
+    if (Current().state == &state) {
+      index = Current().index;
+    } else {
+      index = state.next.fetch_add(1, std::memory_order_relaxed) %
+              state.workers.size();
+    }
+    // Counted before it is visible, so that a worker never sees more tasks
+    // than |pending|.
+    state.pending.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(state.workers[index]->mutex);
+      state.workers[index]->tasks.push_back(std::move(t));
+    }
+    if (state.idle.load() > 0) {
+      std::lock_guard<std::mutex> lock(state.park_mutex);
+      state.park_cv.notify_one();
+    }
+  }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<task> tasks;
+    std::thread thread;
+  };
+
+  // What the workers share. Each of them holds it, so that it outlives the
+  // pool if the pool is destroyed on a worker.
+  struct State {
+    explicit State(size_t spin_count)
+        : spin_count(spin_count),
+          next(0),
+          pending(0),
+          idle(0),
+          stopping(false) {}
+
+    // Takes the most recently posted task of the worker itself.
+    bool Pop(size_t index, task* t) {
+      Worker& worker = *workers[index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.tasks.empty()) return false;
+      *t = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+      return true;
+    }
+
+    // Takes the oldest task of another worker.
+    bool Steal(size_t index, task* t) {
+      for (size_t i = 1; i < workers.size(); ++i) {
+        Worker& victim = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        *t = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+      return false;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t spin_count;
+    std::atomic<size_t> next;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> idle;
+    std::mutex park_mutex;
+    std::condition_variable park_cv;
+    bool stopping;
+  };
+
+  struct CurrentWorker {
+    State* state;
+    size_t index;
+  };
+
+  static CurrentWorker& Current() {
+    thread_local CurrentWorker current = {nullptr, 0};
+    return current;
+  }
+
+  static void Run(std::shared_ptr<State> shared_state, size_t index) {
+    State& state = *shared_state;
+    Current() = {&state, index};
+    task t;
+    for (;;) {
+      if (state.Pop(index, &t) || state.Steal(index, &t)) {
+        state.pending.fetch_sub(1);
+        t();
+        t = nullptr;
+        continue;
+      }
+
+      bool found = false;
+      for (size_t i = 0; i < state.spin_count && !found; ++i) {
+        std::this_thread::yield();
+        found = state.pending.load() > 0;
+      }
+      if (found) continue;
+
+      std::unique_lock<std::mutex> lock(state.park_mutex);
+      state.idle.fetch_add(1);
+      state.park_cv.wait(lock, [&state] {
+        return state.pending.load() > 0 || state.stopping;
+      });
+      state.idle.fetch_sub(1);
+      if (state.stopping && state.pending.load() == 0) return;
+    }
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_THREAD_POOL_H_
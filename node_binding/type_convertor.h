@@ -7,11 +7,110 @@
 
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "napi.h"
+#include "node_binding/string_arena.h"
 
 namespace node_binding {
 
+/**
+ * @brief std::string which is converted from/to a JS string as Latin-1.
+ * It skips UTF-8 transcoding, so use it for strings which are known to
+ * consist of one-byte characters like keys or IDs.
+ */
+class latin1_string : public std::string {
+ public:
+  using std::string::string;
+
+  latin1_string() = default;
+  latin1_string(const std::string& other) : std::string(other) {}
+  latin1_string(std::string&& other) : std::string(std::move(other)) {}
+};
+
+namespace internal {
+
+// Strings which fit in this are converted through a buffer on the stack, so
+// they are transcoded only once and std::string can use its inline storage.
+constexpr size_t kInlineStringBufferSize = 256;
+
+// An UTF-8 sequence is never split, so up to 3 bytes can be left unused in a
+// truncated copy besides the null terminator.
+constexpr size_t kMaxUtf8CharSize = 4;
+
+inline std::string Utf8Value(const Napi::Value& value) {
+  napi_env env = value.Env();
+  char buffer[kInlineStringBufferSize];
+  size_t length;
+  if (napi_get_value_string_utf8(env, value, buffer, sizeof(buffer),
+                                 &length) != napi_ok)
+    return std::string();
+  if (length + kMaxUtf8CharSize < sizeof(buffer))
+    return std::string(buffer, length);
+
+  napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+  std::string ret(length, '\0');
+  napi_get_value_string_utf8(env, value, &ret[0], length + 1, &length);
+  return ret;
+}
+
+// Copies |value| as UTF-8 into the StringArena and returns the null
+// terminated string. |length| is set to its length without the terminator.
+inline const char* Utf8ValueInArena(const Napi::Value& value,
+                                    size_t* length) {
+  napi_env env = value.Env();
+  StringArena& arena = StringArena::Get();
+  char* buffer = arena.Reserve(kInlineStringBufferSize);
+  if (napi_get_value_string_utf8(env, value, buffer, kInlineStringBufferSize,
+                                 length) != napi_ok) {
+    *length = 0;
+    buffer[0] = '\0';
+    return buffer;
+  }
+  if (*length + kMaxUtf8CharSize >= kInlineStringBufferSize) {
+    napi_get_value_string_utf8(env, value, nullptr, 0, length);
+    buffer = arena.Reserve(*length + 1);
+    napi_get_value_string_utf8(env, value, buffer, *length + 1, length);
+  }
+  arena.Commit(*length + 1);
+  return buffer;
+}
+
+inline std::u16string Utf16Value(const Napi::Value& value) {
+  napi_env env = value.Env();
+  char16_t buffer[kInlineStringBufferSize / sizeof(char16_t)];
+  size_t length;
+  if (napi_get_value_string_utf16(env, value, buffer,
+                                  kInlineStringBufferSize / sizeof(char16_t),
+                                  &length) != napi_ok)
+    return std::u16string();
+  if (length + 1 < kInlineStringBufferSize / sizeof(char16_t))
+    return std::u16string(buffer, length);
+
+  napi_get_value_string_utf16(env, value, nullptr, 0, &length);
+  std::u16string ret(length, u'\0');
+  napi_get_value_string_utf16(env, value, &ret[0], length + 1, &length);
+  return ret;
+}
+
+inline latin1_string Latin1Value(const Napi::Value& value) {
+  napi_env env = value.Env();
+  char buffer[kInlineStringBufferSize];
+  size_t length;
+  if (napi_get_value_string_latin1(env, value, buffer, sizeof(buffer),
+                                   &length) != napi_ok)
+    return latin1_string();
+  if (length + 1 < sizeof(buffer)) return latin1_string(buffer, length);
+
+  napi_get_value_string_latin1(env, value, nullptr, 0, &length);
+  latin1_string ret(length, '\0');
+  napi_get_value_string_latin1(env, value, &ret[0], length + 1, &length);
+  return ret;
+}
+
+}  // namespace internal
+
 template <typename T, typename SFINAE = void>
 class TypeConvertor;
 
@@ -192,7 +291,7 @@ template <typename T>
 class TypeConvertor<T, std::enable_if_t<std::is_same<std::string, T>::value>> {
  public:
   static std::string ToNativeValue(const Napi::Value& value) {
-    return value.As<Napi::String>().Utf8Value();
+    return internal::Utf8Value(value);
   }
 
   static bool IsConvertible(const Napi::Value& value) {
@@ -204,11 +303,51 @@ class TypeConvertor<T, std::enable_if_t<std::is_same<std::string, T>::value>> {
   }
 };
 
+template <typename T>
+class TypeConvertor<T,
+                    std::enable_if_t<std::is_same<std::u16string, T>::value>> {
+ public:
+  static std::u16string ToNativeValue(const Napi::Value& value) {
+    return internal::Utf16Value(value);
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    return value.IsString();
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const std::u16string& value) {
+    return Napi::String::New(env, value);
+  }
+};
+
+template <>
+class TypeConvertor<latin1_string> {
+ public:
+  static latin1_string ToNativeValue(const Napi::Value& value) {
+    return internal::Latin1Value(value);
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    return value.IsString();
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const latin1_string& value) {
+    napi_value ret;
+    napi_status status =
+        napi_create_string_latin1(env, value.data(), value.size(), &ret);
+    if (status != napi_ok) return Napi::Value();
+    return Napi::Value(env, ret);
+  }
+};
+
 template <typename T>
 class TypeConvertor<T, std::enable_if_t<std::is_enum<T>::value>> {
  public:
-  static std::underlying_type_t<T> ToNativeValue(const Napi::Value& value) {
-    return TypeConvertor<std::underlying_type_t<T>>::ToNativeValue();
+  static T ToNativeValue(const Napi::Value& value) {
+    return static_cast<T>(
+        TypeConvertor<std::underlying_type_t<T>>::ToNativeValue(value));
   }
 
   static bool IsConvertible(const Napi::Value& value) {
@@ -221,11 +360,18 @@ class TypeConvertor<T, std::enable_if_t<std::is_enum<T>::value>> {
   }
 };
 
+/**
+ * @brief const char* <-> string
+ *
+ * The converted string lives in a per-thread buffer and is valid only during
+ * the synchronous call.
+ */
 template <typename T>
 class TypeConvertor<T, std::enable_if_t<std::is_same<const char*, T>::value>> {
  public:
-  static std::string ToNativeValue(const Napi::Value& value) {
-    return value.As<Napi::String>().Utf8Value();
+  static const char* ToNativeValue(const Napi::Value& value) {
+    size_t length;
+    return internal::Utf8ValueInArena(value, &length);
   }
 
   static bool IsConvertible(const Napi::Value& value) {
@@ -237,6 +383,43 @@ class TypeConvertor<T, std::enable_if_t<std::is_same<const char*, T>::value>> {
   }
 };
 
+namespace internal {
+
+// Whether an argument of type T borrows memory which is valid only during
+// the synchronous call, like the StringArena or the backing store of a
+// TypedArray.
+template <typename T>
+struct IsBorrowedArg : std::false_type {};
+
+template <>
+struct IsBorrowedArg<const char*> : std::true_type {};
+
+// The copy of an argument of type T which an asynchronous call keeps after
+// the synchronous call returns. It owns what T borrows, and Borrow() gives
+// T back from it on the worker.
+template <typename T>
+struct OwnedArg {
+  using type = T;
+
+  static type Own(T value) { return value; }
+  static type& Borrow(type& value) { return value; }
+};
+
+template <>
+struct OwnedArg<const char*> {
+  using type = std::string;
+
+  static type Own(const char* value) { return value ? value : ""; }
+  static const char* Borrow(const type& value) { return value.c_str(); }
+};
+
+// Whether a bound function which returns R is still running after the
+// synchronous call returns, so that it can't take borrowed arguments.
+template <typename R>
+struct IsDeferredResult : std::false_type {};
+
+}  // namespace internal
+
 template <>
 class TypeConvertor<Napi::Object> {
  public:
@@ -281,6 +464,98 @@ Napi::Value ToJSValue(const Napi::Env& env, T&& value) {
   return TypeConvertor<std::decay_t<T>>::ToJSValue(env, std::forward<T>(value));
 }
 
+namespace internal {
+
+template <typename T, typename SFINAE = void>
+struct HasTryToNativeValue : std::false_type {};
+
+template <typename T>
+struct HasTryToNativeValue<
+    T, decltype(void(TypeConvertor<T>::TryToNativeValue(
+           std::declval<const Napi::Value&>(), std::declval<T*>())))>
+    : std::true_type {};
+
+template <typename T>
+std::enable_if_t<HasTryToNativeValue<T>::value, bool> TryToNativeValue(
+    const Napi::Value& value, T* out) {
+  return TypeConvertor<T>::TryToNativeValue(value, out);
+}
+
+// Convertors which only have IsConvertible() and ToNativeValue() still work,
+// they are just called one after another.
+template <typename T>
+std::enable_if_t<!HasTryToNativeValue<T>::value, bool> TryToNativeValue(
+    const Napi::Value& value, T* out) {
+  if (!TypeConvertor<T>::IsConvertible(value)) return false;
+  *out = TypeConvertor<T>::ToNativeValue(value);
+  return true;
+}
+
+// The napi_valuetype which a JS value has to have to be converted to T, or
+// kAnyValueType if it can't be told by the type alone. It is used to pick an
+// overload by the type of its first argument.
+constexpr int kAnyValueType = -1;
+
+template <typename T, typename SFINAE = void>
+struct ValueTypeTag : std::integral_constant<int, kAnyValueType> {};
+
+template <typename T>
+struct ValueTypeTag<T, std::enable_if_t<std::is_same<bool, T>::value>>
+    : std::integral_constant<int, napi_boolean> {};
+
+// 64-bit integers are BigInt if NAPI_EXPERIMENTAL is on.
+template <typename T>
+struct ValueTypeTag<
+    T, std::enable_if_t<(std::is_arithmetic<T>::value &&
+                         !std::is_same<bool, T>::value &&
+                         !(std::is_integral<T>::value && sizeof(T) == 8)) ||
+                        std::is_enum<T>::value>>
+    : std::integral_constant<int, napi_number> {};
+
+template <typename T>
+struct ValueTypeTag<
+    T, std::enable_if_t<std::is_same<std::string, T>::value ||
+                        std::is_same<std::u16string, T>::value ||
+                        std::is_same<latin1_string, T>::value ||
+                        std::is_same<const char*, T>::value>>
+    : std::integral_constant<int, napi_string> {};
+
+// Checks and converts |value|, then appends it to |out|.
+template <typename T>
+std::enable_if_t<std::is_default_constructible<T>::value, bool>
+AppendNativeValue(const Napi::Value& value, std::vector<T>* out) {
+  T element;
+  if (!internal::TryToNativeValue<T>(value, &element)) return false;
+  out->push_back(std::move(element));
+  return true;
+}
+
+template <typename T>
+std::enable_if_t<!std::is_default_constructible<T>::value, bool>
+AppendNativeValue(const Napi::Value& value, std::vector<T>* out) {
+  if (!TypeConvertor<T>::IsConvertible(value)) return false;
+  out->push_back(TypeConvertor<T>::ToNativeValue(value));
+  return true;
+}
+
+}  // namespace internal
+
+/**
+ * @brief Checks and converts |value| in a single pass. Returns false if
+ * |value| isn't convertible to T, in which case |out| is unspecified.
+ *
+ * A TypeConvertor<T> may implement
+ * `static bool TryToNativeValue(const Napi::Value& value, T* out)` to avoid
+ * inspecting |value| twice; otherwise IsConvertible() and ToNativeValue() are
+ * used.
+ *
+ * @tparam T
+ */
+template <typename T>
+bool TryToNativeValue(const Napi::Value& value, T* out) {
+  return internal::TryToNativeValue<T>(value, out);
+}
+
 }  // namespace node_binding
 
 #endif  // NODE_BINDING_TYPE_CONVERTOR_H_
\ No newline at end of file
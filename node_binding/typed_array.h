@@ -0,0 +1,248 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NODE_BINDING_TYPED_ARRAY_H_
+#define NODE_BINDING_TYPED_ARRAY_H_
+
+#include <string.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "napi.h"
+#include "node_binding/type_convertor.h"
+
+namespace node_binding {
+
+namespace internal {
+
+template <typename T, typename SFINAE = void>
+struct TypedArrayTraits {
+  static constexpr bool kSupported = false;
+};
+
+// 64-bit integers map to BigInt64Array and BigUint64Array, the only
+// TypedArrays of their width, whether or not NAPI_EXPERIMENTAL is on. Their
+// scalars, and the elements of an Array, are numbers unless it is on.
+template <typename T>
+struct TypedArrayTraits<
+    T, std::enable_if_t<std::is_integral<T>::value &&
+                        !std::is_same<bool, T>::value && sizeof(T) <= 8>> {
+  static constexpr bool kSupported = true;
+  static constexpr napi_typedarray_type kType =
+      sizeof(T) == 1
+          ? (std::is_signed<T>::value ? napi_int8_array : napi_uint8_array)
+          : sizeof(T) == 2
+                ? (std::is_signed<T>::value ? napi_int16_array
+                                            : napi_uint16_array)
+                : sizeof(T) == 4 ? (std::is_signed<T>::value
+                                        ? napi_int32_array
+                                        : napi_uint32_array)
+                                 : (std::is_signed<T>::value
+                                        ? napi_bigint64_array
+                                        : napi_biguint64_array);
+
+  static bool Matches(napi_typedarray_type type) {
+    return type == kType ||
+           (kType == napi_uint8_array && type == napi_uint8_clamped_array);
+  }
+};
+
+template <typename T>
+struct TypedArrayTraits<T, std::enable_if_t<std::is_same<float, T>::value>> {
+  static constexpr bool kSupported = true;
+  static constexpr napi_typedarray_type kType = napi_float32_array;
+
+  static bool Matches(napi_typedarray_type type) { return type == kType; }
+};
+
+template <typename T>
+struct TypedArrayTraits<T, std::enable_if_t<std::is_same<double, T>::value>> {
+  static constexpr bool kSupported = true;
+  static constexpr napi_typedarray_type kType = napi_float64_array;
+
+  static bool Matches(napi_typedarray_type type) { return type == kType; }
+};
+
+// Returns true and fills |type|, |length| and |data| if |value| is a
+// TypedArray. |data| already points to the first element, that is, it is
+// adjusted by the byte offset of the view.
+inline bool GetTypedArrayInfo(const Napi::Value& value,
+                              napi_typedarray_type* type, size_t* length,
+                              void** data) {
+  if (!value.IsTypedArray()) return false;
+  return napi_get_typedarray_info(value.Env(), value, type, length, data,
+                                  nullptr, nullptr) == napi_ok;
+}
+
+// Returns true if |value| is a TypedArray whose element type is T.
+template <typename T>
+std::enable_if_t<TypedArrayTraits<T>::kSupported, bool> IsTypedArrayOf(
+    const Napi::Value& value) {
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  return GetTypedArrayInfo(value, &type, &length, &data) &&
+         TypedArrayTraits<T>::Matches(type);
+}
+
+template <typename T>
+std::enable_if_t<!TypedArrayTraits<T>::kSupported, bool> IsTypedArrayOf(
+    const Napi::Value& value) {
+  return false;
+}
+
+// Copies the elements of |value| into |out| with a single memcpy if |value|
+// is a TypedArray whose element type is T.
+template <typename T>
+std::enable_if_t<TypedArrayTraits<T>::kSupported, bool> CopyFromTypedArray(
+    const Napi::Value& value, std::vector<T>* out) {
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  if (!GetTypedArrayInfo(value, &type, &length, &data) ||
+      !TypedArrayTraits<T>::Matches(type))
+    return false;
+  const T* begin = static_cast<const T*>(data);
+  out->assign(begin, begin + length);
+  return true;
+}
+
+template <typename T>
+std::enable_if_t<!TypedArrayTraits<T>::kSupported, bool> CopyFromTypedArray(
+    const Napi::Value& value, std::vector<T>* out) {
+  return false;
+}
+
+template <typename T>
+Napi::Value NewTypedArray(napi_env env, napi_value arraybuffer, size_t length) {
+  napi_value ret;
+  napi_status status =
+      napi_create_typedarray(env, TypedArrayTraits<T>::kType, length,
+                             arraybuffer, 0, &ret);
+  if (status != napi_ok) return Napi::Value();
+  return Napi::Value(env, ret);
+}
+
+template <typename T>
+Napi::Value CopyToTypedArray(napi_env env, const T* data, size_t length) {
+  void* buffer;
+  napi_value arraybuffer;
+  napi_status status =
+      napi_create_arraybuffer(env, length * sizeof(T), &buffer, &arraybuffer);
+  if (status != napi_ok) return Napi::Value();
+  if (length > 0) memcpy(buffer, data, length * sizeof(T));
+  return NewTypedArray<T>(env, arraybuffer, length);
+}
+
+}  // namespace internal
+
+/**
+ * @brief std::vector<T> which is converted from/to a TypedArray instead of a
+ * generic Array. T has to be an arithmetic type other than bool.
+ *
+ * A 64-bit integer is converted from/to a BigInt64Array or BigUint64Array
+ * even if NAPI_EXPERIMENTAL is off, where a single int64_t is a number.
+ *
+ * @tparam T
+ */
+template <typename T>
+class typed_array : public std::vector<T> {
+  static_assert(internal::TypedArrayTraits<T>::kSupported,
+                "typed_array<T> requires T to be an arithmetic type "
+                "which has a corresponding TypedArray.");
+
+ public:
+  using std::vector<T>::vector;
+
+  typed_array() = default;
+  typed_array(const std::vector<T>& other) : std::vector<T>(other) {}
+  typed_array(std::vector<T>&& other) : std::vector<T>(std::move(other)) {}
+};
+
+/**
+ * @brief node_binding::typed_array<T> <-> TypedArray
+ *
+ * When a typed_array is returned by value, the external ArrayBuffer takes
+ * ownership of its storage and frees it when the ArrayBuffer is collected.
+ * If the runtime doesn't allow external buffers, the elements are copied with
+ * a single memcpy.
+ *
+ * @tparam T
+ */
+template <typename T>
+class TypeConvertor<typed_array<T>> {
+ public:
+  static typed_array<T> ToNativeValue(const Napi::Value& value) {
+    typed_array<T> ret;
+    if (internal::CopyFromTypedArray<T>(value, &ret)) return ret;
+
+    Napi::Array arr = value.As<Napi::Array>();
+    uint32_t arr_length = arr.Length();
+    ret.reserve(arr_length);
+    for (uint32_t i = 0; i < arr_length; ++i) {
+      ret.push_back(TypeConvertor<T>::ToNativeValue(arr[i]));
+    }
+    return ret;
+  }
+
+  static bool IsConvertible(const Napi::Value& value) {
+    if (value.IsTypedArray()) return internal::IsTypedArrayOf<T>(value);
+
+    if (!value.IsArray()) return false;
+    Napi::Array arr = value.As<Napi::Array>();
+    uint32_t arr_length = arr.Length();
+    for (uint32_t i = 0; i < arr_length; ++i) {
+      if (!TypeConvertor<T>::IsConvertible(arr[i])) return false;
+    }
+    return true;
+  }
+
+  static bool TryToNativeValue(const Napi::Value& value, typed_array<T>* out) {
+    if (value.IsTypedArray())
+      return internal::CopyFromTypedArray<T>(value, out);
+
+    if (!value.IsArray()) return false;
+    Napi::Array arr = value.As<Napi::Array>();
+    uint32_t arr_length = arr.Length();
+    out->clear();
+    out->reserve(arr_length);
+    for (uint32_t i = 0; i < arr_length; ++i) {
+      if (!internal::AppendNativeValue<T>(arr.Get(i), out)) return false;
+    }
+    return true;
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env,
+                               const typed_array<T>& value) {
+    return internal::CopyToTypedArray(env, value.data(), value.size());
+  }
+
+  static Napi::Value ToJSValue(const Napi::Env& env, typed_array<T>&& value) {
+    if (value.empty()) return internal::CopyToTypedArray<T>(env, nullptr, 0);
+
+    size_t length = value.size();
+    std::vector<T>* storage = new std::vector<T>(std::move(value));
+    napi_value arraybuffer;
+    napi_status status = napi_create_external_arraybuffer(
+        env, storage->data(), length * sizeof(T),
+        [](napi_env env, void* data, void* hint) {
+          delete static_cast<std::vector<T>*>(hint);
+        },
+        storage, &arraybuffer);
+    if (status != napi_ok) {
+      // e.g, napi_no_external_buffers_allowed.
+      Napi::Value ret =
+          internal::CopyToTypedArray(env, storage->data(), length);
+      delete storage;
+      return ret;
+    }
+    return internal::NewTypedArray<T>(env, arraybuffer, length);
+  }
+};
+
+}  // namespace node_binding
+
+#endif  // NODE_BINDING_TYPED_ARRAY_H_
@@ -6,11 +6,15 @@
 #define NODE_BINDING_TYPED_CALL_H_
 
 #include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "napi.h"
 #include "node_binding/arg_type_checker.h"
 #include "node_binding/macros.h"
+#include "node_binding/string_arena.h"
 #include "node_binding/template_util.h"
 #include "node_binding/type_convertor.h"
 
@@ -18,65 +22,175 @@ namespace node_binding {
 
 namespace internal {
 
-template <size_t Idx, typename ArgList>
-auto Arg(const Napi::CallbackInfo& info) {
-  return TypeConvertor<internal::PickTypeListItem<Idx, ArgList>>::ToNativeValue(
-      info[Idx]);
+constexpr size_t MaxOf(std::initializer_list<size_t> values) {
+  size_t ret = 0;
+  for (size_t value : values) {
+    if (value > ret) ret = value;
+  }
+  return ret;
+}
+
+constexpr bool AllOf(std::initializer_list<bool> values) {
+  for (bool value : values) {
+    if (!value) return false;
+  }
+  return true;
 }
 
+// A task or an async_generator runs after the call returns, when what a
+// borrowed argument points to is gone.
+template <typename R, typename... Args>
+void CheckArgsOutliveCall() {
+  static_assert(!IsDeferredResult<std::decay_t<R>>::value ||
+                    AllOf({!IsBorrowedArg<std::decay_t<Args>>::value...}),
+                "A function which returns a task or an async_generator must "
+                "take owning arguments like std::string or std::vector "
+                "rather than const char*, span or std::string_view.");
+}
+
+// An argument whose convertor implements TryToNativeValue() is checked and
+// converted at once and stored until the call.
+template <typename T,
+          bool = HasTryToNativeValue<T>::value &&
+                 std::is_default_constructible<T>::value>
+class ArgSlot {
+ public:
+  bool Convert(const Napi::Value& value) {
+    return TypeConvertor<T>::TryToNativeValue(value, &value_);
+  }
+
+  void ConvertUnchecked(const Napi::Value& value) {
+    value_ = TypeConvertor<T>::ToNativeValue(value);
+  }
+
+  template <typename RawType>
+  RawType&& Get(const Napi::Value& value) {
+    return std::forward<RawType>(value_);
+  }
+
+ private:
+  T value_;
+};
+
+// Otherwise, it is checked first and converted while calling the function,
+// the same as before TryToNativeValue() was introduced.
+template <typename T>
+class ArgSlot<T, false> {
+ public:
+  bool Convert(const Napi::Value& value) {
+    return TypeConvertor<T>::IsConvertible(value);
+  }
+
+  void ConvertUnchecked(const Napi::Value& value) {}
+
+  template <typename RawType>
+  auto Get(const Napi::Value& value) {
+    return TypeConvertor<T>::ToNativeValue(value);
+  }
+};
+
+/**
+ * @brief Arguments of a bound call. Convert() inspects each argument exactly
+ * once and throws a TypeError for the first mismatched one. If Policy doesn't
+ * check arguments, they are converted without being inspected.
+ */
+template <typename ArgList, typename Indices, typename Policy>
+class ConvertedArgs;
+
+template <typename... Args, size_t... Indices, typename Policy>
+class ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                    Policy> {
+  using ArgList = TypeList<Args...>;
+
+ public:
+  bool Convert(const Napi::CallbackInfo& info) {
+    if (!Policy::kEnabled) {
+      (void)std::initializer_list<int>{
+          (std::get<Indices>(slots_).ConvertUnchecked(info[Indices]), 0)...};
+      return true;
+    }
+    bool ret = true;
+    (void)std::initializer_list<int>{
+        (ret = ret && ConvertArg<Indices>(info), 0)...};
+    return ret;
+  }
+
+  template <size_t Idx>
+  decltype(auto) Get(const Napi::CallbackInfo& info) {
+    return std::get<Idx>(slots_)
+        .template Get<PickRawTypeListItem<Idx, ArgList>>(info[Idx]);
+  }
+
+ private:
+  template <size_t Idx>
+  bool ConvertArg(const Napi::CallbackInfo& info) {
+    if (std::get<Idx>(slots_).Convert(info[Idx])) return true;
+    ThrowArgTypeMismatch(info.Env(), Idx);
+    return false;
+  }
+
+  std::tuple<ArgSlot<PickTypeListItem<Indices, ArgList>>...> slots_;
+};
+
 template <typename R, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, R (*f)(Args...),
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
          std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return f(Arg<Indices, ArgList>(info)...,
+  return f(args.template Get<Indices>(info)...,
            std::forward<DefaultArgs>(def_args)...);
 }
 
 template <typename R, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, std::function<R(Args...)> f,
-         std::index_sequence<Indices...>, DefaultArgs&& ... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return f(Arg<Indices, ArgList>(info)...,
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
+         std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
+  return f(args.template Get<Indices>(info)...,
            std::forward<DefaultArgs>(def_args)...);
 }
 
 template <typename R, typename Class, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, R (Class::*f)(Args...), Class* c,
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
          std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return ((*c).*f)(Arg<Indices, ArgList>(info)...,
+  return ((*c).*f)(args.template Get<Indices>(info)...,
                    std::forward<DefaultArgs>(def_args)...);
 }
 
 template <typename R, typename Class, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, R (Class::*f)(Args...) const,
-         const Class* c, std::index_sequence<Indices...>,
-         DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return ((*c).*f)(Arg<Indices, ArgList>(info)...,
+         const Class* c,
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
+         std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
+  return ((*c).*f)(args.template Get<Indices>(info)...,
                    std::forward<DefaultArgs>(def_args)...);
 }
 
 template <typename R, typename Class, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, R (Class::*f)(Args...) const&,
-         const Class* c, std::index_sequence<Indices...>,
-         DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return ((*c).*f)(Arg<Indices, ArgList>(info)...,
+         const Class* c,
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
+         std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
+  return ((*c).*f)(args.template Get<Indices>(info)...,
                    std::forward<DefaultArgs>(def_args)...);
 }
 
 template <typename R, typename Class, typename... Args, size_t... Indices,
-          typename... DefaultArgs>
+          typename Policy, typename... DefaultArgs>
 R Invoke(const Napi::CallbackInfo& info, R (Class::*f)(Args...) &&, Class* c,
+         ConvertedArgs<TypeList<Args...>, std::index_sequence<Indices...>,
+                       Policy>& args,
          std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return (std::move(*c).*f)(Arg<Indices, ArgList>(info)...,
+  return (std::move(*c).*f)(args.template Get<Indices>(info)...,
                             std::forward<DefaultArgs>(def_args)...);
 }
 
@@ -106,11 +220,11 @@ R Invoke(const Napi::Function& fn, std::index_sequence<I...>, _Tuple&& tup) {
 #else
   Napi::Env env = fn.Env();
   Napi::HandleScope scope(env);
-  std::vector<napi_value> args = {
-      {ToJSValue<decltype(std::get<I>(tup))>(env, std::get<I>(tup))...}};
+  napi_value args[sizeof...(I) > 0 ? sizeof...(I) : 1] = {
+      ToJSValue<decltype(std::get<I>(tup))>(env, std::get<I>(tup))...};
   napi_value result;
-  napi_status status = napi_call_function(env, env.Undefined(), fn, args.size(),
-                                          args.data(), &result);
+  napi_status status = napi_call_function(env, env.Undefined(), fn,
+                                          sizeof...(I), args, &result);
   if ((status) != napi_ok) return R();
   Napi::Value ret(env, result);
   if (ret.IsUndefined()) return R();
@@ -130,132 +244,386 @@ void Invoke(const Napi::Function& fn, std::index_sequence<I...>, _Tuple&& tup) {
 #else
   Napi::Env env = fn.Env();
   Napi::HandleScope scope(env);
-  std::vector<napi_value> args = {
-      {ToJSValue<decltype(std::get<I>(tup))>(env, std::get<I>(tup))...}};
-  napi_call_function(env, env.Undefined(), fn, args.size(), args.data(),
-                     nullptr);
+  napi_value args[sizeof...(I) > 0 ? sizeof...(I) : 1] = {
+      ToJSValue<decltype(std::get<I>(tup))>(env, std::get<I>(tup))...};
+  napi_call_function(env, env.Undefined(), fn, sizeof...(I), args, nullptr);
 #endif
 }
 
-template <typename R, typename... Args, size_t... Indices,
+template <typename Policy = arg_checks::strict, typename R, typename... Args,
           typename... DefaultArgs>
-R Invoke(const Napi::CallbackInfo& info, std::function<R(Args...)> f,
-         std::index_sequence<Indices...>, DefaultArgs&&... def_args) {
-  using ArgList = internal::TypeList<Args...>;
-  return f(internal::Arg<Indices, ArgList>(info)...,
-           std::forward<DefaultArgs>(def_args)...);
-}
-
-template <typename R, typename... Args, typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info,
                       std::function<R(Args...)> f, DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   Napi::EscapableHandleScope scope(info.Env());
   return scope.Escape(ToJSValue(
-      env, internal::Invoke(info, f, std::make_index_sequence<num_args>(),
+      env, internal::Invoke(info, f, args, std::make_index_sequence<num_args>(),
                             std::forward<DefaultArgs>(def_args)...)));
 }
 
-template <typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename... Args,
+          typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info,
                       std::function<void(Args...)> f, DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, args, std::make_index_sequence<num_args>(),
                             std::forward<DefaultArgs>(def_args)...);
 }
 
-template <typename R, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename R, typename... Args,
+          typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info, R (*f)(Args...),
                       DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   Napi::EscapableHandleScope scope(info.Env());
   return scope.Escape(ToJSValue(
-      env, internal::Invoke(info, f, std::make_index_sequence<num_args>(),
+      env, internal::Invoke(info, f, args, std::make_index_sequence<num_args>(),
                             std::forward<DefaultArgs>(def_args)...)));
 }
 
-template <typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename... Args,
+          typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info, void (*f)(Args...),
                DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, args, std::make_index_sequence<num_args>(),
                    std::forward<DefaultArgs>(def_args)...);
 }
 
-template <typename R, typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename R, typename Class,
+          typename... Args, typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info, R (Class::*f)(Args...),
                       Class* c, DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   return ToJSValue(
       info.Env(),
-      internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+      internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                        std::forward<DefaultArgs>(def_args)...));
 }
 
-template <typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename Class,
+          typename... Args, typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info, void (Class::*f)(Args...),
                Class* c, DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                    std::forward<DefaultArgs>(def_args)...);
 }
 
-template <typename R, typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename R, typename Class,
+          typename... Args, typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info,
                       R (Class::*f)(Args...) const, const Class* c,
                       DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   return ToJSValue(
       info.Env(),
-      internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+      internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                        std::forward<DefaultArgs>(def_args)...));
 }
 
-template <typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename Class,
+          typename... Args, typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info, void (Class::*f)(Args...) const,
                const Class* c, DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                    std::forward<DefaultArgs>(def_args)...);
 }
 
-template <typename R, typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename R, typename Class,
+          typename... Args, typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info,
                       R (Class::*f)(Args...) const&, const Class* c,
                       DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   return ToJSValue(
       info.Env(),
-      internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+      internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                        std::forward<DefaultArgs>(def_args)...));
 }
 
-template <typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename Class,
+          typename... Args, typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info, void (Class::*f)(Args...) const&,
                const Class* c, DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                    std::forward<DefaultArgs>(def_args)...);
 }
 
-template <typename R, typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename R, typename Class,
+          typename... Args, typename... DefaultArgs>
 Napi::Value TypedCall(const Napi::CallbackInfo& info, R (Class::*f)(Args...) &&,
                       Class* c, DefaultArgs&&... def_args) {
-  RETURN_UNDEFINED_IF_FAILED_TO_CHECK_ARGS();
+  internal::CheckArgsOutliveCall<R, Args...>();
+  RETURN_UNDEFINED_IF_FAILED_TO_CONVERT_ARGS();
   return ToJSValue(
       info.Env(),
-      internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+      internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                        std::forward<DefaultArgs>(def_args)...));
 }
 
-template <typename Class, typename... Args, typename... DefaultArgs>
+template <typename Policy = arg_checks::strict, typename Class,
+          typename... Args, typename... DefaultArgs>
 void TypedCall(const Napi::CallbackInfo& info, void (Class::*f)(Args...) &&,
                Class* c, DefaultArgs&&... def_args) {
-  RETURN_IF_FAILED_TO_CHECK_ARGS();
-  internal::Invoke(info, f, c, std::make_index_sequence<num_args>(),
+  RETURN_IF_FAILED_TO_CONVERT_ARGS();
+  internal::Invoke(info, f, c, args, std::make_index_sequence<num_args>(),
                    std::forward<DefaultArgs>(def_args)...);
 }
 
+namespace internal {
+
+template <typename R>
+struct CallResult {
+  template <typename Fn>
+  static Napi::Value Get(const Napi::CallbackInfo& info, Fn&& fn) {
+    return fn();
+  }
+};
+
+template <>
+struct CallResult<void> {
+  template <typename Fn>
+  static Napi::Value Get(const Napi::CallbackInfo& info, Fn&& fn) {
+    fn();
+    return info.Env().Undefined();
+  }
+};
+
+template <size_t NumArgs, typename ArgList>
+struct FirstArgValueTypeTag : ValueTypeTag<PickTypeListItem<0, ArgList>> {};
+
+template <typename ArgList>
+struct FirstArgValueTypeTag<0, ArgList>
+    : std::integral_constant<int, kAnyValueType> {};
+
+// kAnyValueType and each napi_valuetype.
+constexpr int kNumValueTypeTags = napi_bigint + 2;
+
+// index[n][0] is the overload which takes n arguments. If more than one
+// overload takes n arguments, |typed| is set and index[n][type + 1] is the
+// one whose first argument accepts napi_valuetype |type|.
+template <size_t MaxArgs>
+struct OverloadTable {
+  int index[MaxArgs + 1][kNumValueTypeTags];
+  bool typed[MaxArgs + 1];
+};
+
+template <size_t MaxArgs, size_t N>
+constexpr OverloadTable<MaxArgs> MakeOverloadTable(const size_t (&num_args)[N],
+                                                   const int (&tags)[N]) {
+  OverloadTable<MaxArgs> table{};
+  for (size_t n = 0; n <= MaxArgs; ++n) {
+    int first = -1;
+    size_t count = 0;
+    for (size_t i = 0; i < N; ++i) {
+      if (num_args[i] != n) continue;
+      if (first < 0) first = static_cast<int>(i);
+      ++count;
+    }
+    table.typed[n] = count > 1 && n > 0;
+    for (int tag = 0; tag < kNumValueTypeTags; ++tag) {
+      table.index[n][tag] = first;
+      if (!table.typed[n]) continue;
+      for (size_t i = 0; i < N; ++i) {
+        if (num_args[i] == n &&
+            (tags[i] == kAnyValueType || tags[i] == tag - 1)) {
+          table.index[n][tag] = static_cast<int>(i);
+          break;
+        }
+      }
+    }
+  }
+  return table;
+}
+
+}  // namespace internal
+
+/**
+ * @brief A function (or a member function) with its trailing default
+ * arguments, which is an entry of node_binding::overloads.
+ *
+ * @tparam F
+ * @tparam DefaultArgs
+ */
+template <typename F, typename... DefaultArgs>
+class overload {
+  using Traits = internal::FunctionTraits<F>;
+
+ public:
+  using ReturnType = typename Traits::ReturnType;
+
+  // The number of JS arguments.
+  static constexpr size_t kNumArgs = Traits::kArity - sizeof...(DefaultArgs);
+  static constexpr int kValueTypeTag =
+      internal::FirstArgValueTypeTag<kNumArgs,
+                                     typename Traits::ArgList>::value;
+
+  explicit overload(F f, DefaultArgs... def_args)
+      : f_(f), def_args_(std::move(def_args)...) {}
+
+  template <typename Policy = arg_checks::strict, typename... Receiver>
+  Napi::Value Call(const Napi::CallbackInfo& info, Receiver*... c) const {
+    return CallImpl<Policy>(info, std::index_sequence_for<DefaultArgs...>(),
+                            c...);
+  }
+
+  // Calls fn(f, def_args...).
+  template <typename Fn>
+  decltype(auto) Apply(Fn&& fn) const {
+    return ApplyImpl(std::forward<Fn>(fn),
+                     std::index_sequence_for<DefaultArgs...>());
+  }
+
+ private:
+  template <typename Policy, size_t... Is, typename... Receiver>
+  Napi::Value CallImpl(const Napi::CallbackInfo& info,
+                       std::index_sequence<Is...>, Receiver*... c) const {
+    return internal::CallResult<ReturnType>::Get(info, [&] {
+      return TypedCall<Policy>(info, f_, c...,
+                               DefaultArgs(std::get<Is>(def_args_))...);
+    });
+  }
+
+  template <typename Fn, size_t... Is>
+  decltype(auto) ApplyImpl(Fn&& fn, std::index_sequence<Is...>) const {
+    return fn(f_, std::get<Is>(def_args_)...);
+  }
+
+  F f_;
+  std::tuple<DefaultArgs...> def_args_;
+};
+
+/**
+ * @brief Overloads which are picked by the number of arguments and, if more
+ * than one takes the same number, by the type of the first argument.
+ *
+ * The dispatch table is built at compile time, so an overload is selected by
+ * an indexed jump without probing each of them with IsConvertible().
+ *
+ * @tparam Overloads node_binding::overload<>
+ */
+template <typename... Overloads>
+class overloads {
+ public:
+  static constexpr size_t kMaxArgs =
+      internal::MaxOf({Overloads::kNumArgs...});
+
+  explicit overloads(Overloads... o) : overloads_(std::move(o)...) {}
+
+  // Returns the index of the overload which matches |info|. If there is no
+  // overload which takes info.Length() arguments, throws a TypeError and
+  // returns -1.
+  int Select(const Napi::CallbackInfo& info) const {
+    static constexpr size_t kNumArgs[] = {Overloads::kNumArgs...};
+    static constexpr int kTags[] = {Overloads::kValueTypeTag...};
+    static constexpr internal::OverloadTable<kMaxArgs> kTable =
+        internal::MakeOverloadTable<kMaxArgs>(kNumArgs, kTags);
+
+    size_t n = info.Length();
+    int index = n <= kMaxArgs ? kTable.index[n][0] : -1;
+    if (index < 0) {
+      THROW_JS_WRONG_NUMBER_OF_ARGUMENTS(info.Env());
+      return -1;
+    }
+    if (kTable.typed[n]) {
+      napi_valuetype type;
+      if (napi_typeof(info.Env(), info[0], &type) == napi_ok)
+        index = kTable.index[n][type + 1];
+    }
+    return index;
+  }
+
+  template <size_t I>
+  const auto& get() const {
+    return std::get<I>(overloads_);
+  }
+
+ private:
+  std::tuple<Overloads...> overloads_;
+};
+
+namespace internal {
+
+template <typename F, typename... DefaultArgs>
+const overload<F, DefaultArgs...>& AsOverload(
+    const overload<F, DefaultArgs...>& o) {
+  return o;
+}
+
+template <typename F>
+overload<F> AsOverload(F f) {
+  return overload<F>(f);
+}
+
+template <typename T>
+using AsOverloadType = std::decay_t<decltype(AsOverload(std::declval<T>()))>;
+
+template <typename Policy, size_t I, typename OverloadsT,
+          typename... Receiver>
+Napi::Value CallOverload(const OverloadsT& o, const Napi::CallbackInfo& info,
+                         Receiver*... c) {
+  return o.template get<I>().template Call<Policy>(info, c...);
+}
+
+template <typename Policy, typename OverloadsT, size_t... Is,
+          typename... Receiver>
+Napi::Value CallOverloads(const OverloadsT& o, std::index_sequence<Is...>,
+                          const Napi::CallbackInfo& info, Receiver*... c) {
+  using Thunk = Napi::Value (*)(const OverloadsT&, const Napi::CallbackInfo&,
+                                Receiver*...);
+  static constexpr Thunk kThunks[] = {
+      &CallOverload<Policy, Is, OverloadsT, Receiver...>...};
+
+  int index = o.Select(info);
+  if (index < 0) return info.Env().Undefined();
+  return kThunks[index](o, info, c...);
+}
+
+}  // namespace internal
+
+/**
+ * @brief Binds |f| with trailing default arguments as an overload.
+ *
+ * @code
+ * TypedCall(info,
+ *           Overloads(Overload(&Calculator::Increment, 1),
+ *                     Overload(&Calculator::Increment)),
+ *           calculator_.get());
+ * @endcode
+ */
+template <typename F, typename... DefaultArgs>
+overload<F, std::decay_t<DefaultArgs>...> Overload(F f,
+                                                   DefaultArgs&&... def_args) {
+  return overload<F, std::decay_t<DefaultArgs>...>(
+      f, std::forward<DefaultArgs>(def_args)...);
+}
+
+/**
+ * @brief Combines overloads. A function without default arguments may be
+ * passed as it is.
+ */
+template <typename... Ts>
+overloads<internal::AsOverloadType<Ts>...> Overloads(Ts... o) {
+  return overloads<internal::AsOverloadType<Ts>...>(
+      internal::AsOverload(o)...);
+}
+
+template <typename Policy = arg_checks::strict, typename... Overloads,
+          typename... Receiver>
+Napi::Value TypedCall(const Napi::CallbackInfo& info,
+                      const overloads<Overloads...>& o, Receiver*... c) {
+  return internal::CallOverloads<Policy>(
+      o, std::index_sequence_for<Overloads...>(), info, c...);
+}
+
 }  // namespace node_binding
 
 #endif  // NODE_BINDING_TYPED_CALL_H_
\ No newline at end of file
@@ -2,16 +2,55 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "node_binding/batch.h"
+#include "node_binding/bind.h"
+#include "node_binding/prepared_callback.h"
 #include "node_binding/typed_call.h"
 
 double CAdd(double arg0, double arg1) { return arg0 + arg1; }
 
+double last_value = 0;
+
+void CSetLastValue(double value) { last_value = value; }
+
+double CGetLastValue() { return last_value; }
+
+std::string CLabel(const std::string& name, int n) {
+  return name + std::to_string(n);
+}
+
+double CSumOf(node_binding::prepared_callback<double(int)> fn, int n) {
+  node_binding::callback_scope scope(fn.Env(), 64);
+  double sum = 0;
+  for (int i = 0; i < n; ++i) {
+    sum += fn(scope, i);
+  }
+  return sum;
+}
+
 Napi::Value Add(const Napi::CallbackInfo& info) {
   return node_binding::TypedCall(info, &CAdd);
 }
 
+Napi::Value SumOf(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CSumOf);
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("add", Napi::Function::New(env, Add));
+  exports.Set("sumOf", Napi::Function::New(env, SumOf));
+  exports.Set("boundAdd", NODE_BINDING_BIND(&CAdd)::New(env, "boundAdd"));
+  exports.Set("uncheckedAdd",
+              NODE_BINDING_BIND_WITH_CHECKS(
+                  &CAdd, node_binding::arg_checks::unchecked)::New(env));
+  exports.Set("addBatch",
+              NODE_BINDING_BIND_BATCH(&CAdd)::New(env, "addBatch"));
+  exports.Set("labelBatch",
+              NODE_BINDING_BIND_BATCH(&CLabel)::New(env, "labelBatch"));
+  exports.DefineProperties({
+      NODE_BINDING_BIND(&CSetLastValue)::Descriptor("setLastValue"),
+      NODE_BINDING_BIND(&CGetLastValue)::Descriptor("getLastValue"),
+  });
   return exports;
 }
 
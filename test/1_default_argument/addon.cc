@@ -16,8 +16,35 @@ Napi::Value Add(const Napi::CallbackInfo& info) {
   }
 }
 
+std::string CRepeat(std::string str, int n) {
+  std::string ret;
+  for (int i = 0; i < n; ++i) {
+    ret += str;
+  }
+  return ret;
+}
+
+std::string CDescribeNumber(double value) { return "number"; }
+
+std::string CDescribeString(std::string value) { return "string"; }
+
+Napi::Value OverloadedAdd(const Napi::CallbackInfo& info) {
+  static const auto overloads = node_binding::Overloads(
+      node_binding::Overload(&CAdd, 1, 2), node_binding::Overload(&CAdd, 2),
+      &CAdd);
+  return node_binding::TypedCall(info, overloads);
+}
+
+Napi::Value Describe(const Napi::CallbackInfo& info) {
+  static const auto overloads =
+      node_binding::Overloads(&CDescribeNumber, &CDescribeString, &CRepeat);
+  return node_binding::TypedCall(info, overloads);
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("add", Napi::Function::New(env, Add));
+  exports.Set("overloadedAdd", Napi::Function::New(env, OverloadedAdd));
+  exports.Set("describe", Napi::Function::New(env, Describe));
   return exports;
 }
 
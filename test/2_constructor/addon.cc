@@ -5,6 +5,7 @@
 #include "point.h"
 
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
 #include "node_binding/typed_call.h"
 
 class PointJs : public Napi::ObjectWrap<PointJs> {
@@ -13,19 +14,14 @@ class PointJs : public Napi::ObjectWrap<PointJs> {
   PointJs(const Napi::CallbackInfo& info);
 
  private:
-  static Napi::FunctionReference constructor_;
-
   Point point_;
 };
 
-Napi::FunctionReference PointJs::constructor_;
-
 // static
 void PointJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(env, "Point", {});
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  node_binding::SetConstructor<PointJs>(env, func);
 
   exports.Set("Point", func);
 }
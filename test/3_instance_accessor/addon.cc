@@ -5,6 +5,7 @@
 #include "point.h"
 
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
 #include "node_binding/typed_call.h"
 
 class PointJs : public Napi::ObjectWrap<PointJs> {
@@ -29,13 +30,9 @@ class PointJs : public Napi::ObjectWrap<PointJs> {
   }
 
  private:
-  static Napi::FunctionReference constructor_;
-
   Point point_;
 };
 
-Napi::FunctionReference PointJs::constructor_;
-
 // static
 void PointJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func =
@@ -45,8 +42,7 @@ void PointJs::Init(Napi::Env env, Napi::Object exports) {
                       InstanceAccessor("y", &PointJs::GetY, &PointJs::SetY),
                   });
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  node_binding::SetConstructor<PointJs>(env, func);
 
   exports.Set("Point", func);
 }
@@ -65,8 +61,14 @@ PointJs::PointJs(const Napi::CallbackInfo& info)
   }
 }
 
+// Creates a Point by the constructor of the env which calls it.
+Napi::Value MakePoint(const Napi::CallbackInfo& info) {
+  return node_binding::NewInstance<PointJs>(info.Env(), {info[0], info[1]});
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   PointJs::Init(env, exports);
+  exports.Set("makePoint", Napi::Function::New(env, MakePoint));
 
   return exports;
 }
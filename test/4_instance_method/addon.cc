@@ -4,7 +4,10 @@
 
 #include <memory>
 
+#include "node_binding/bind.h"
 #include "node_binding/constructor.h"
+#include "node_binding/instance_data.h"
+#include "node_binding/promise.h"
 #include "node_binding/typed_call.h"
 #include "rect.h"
 
@@ -17,23 +20,36 @@ class RectJs : public Napi::ObjectWrap<RectJs> {
     return node_binding::TypedCall(info, &Rect::size, rect_.get());
   }
 
- private:
-  static Napi::FunctionReference constructor_;
+  int ScaledSize(int k) const { return rect_->size() * k; }
+
+#if (NAPI_VERSION > 3)
+  Napi::Value SizeAsync(const Napi::CallbackInfo& info) {
+    return node_binding::TypedCallAsync(info, &Rect::size, rect_.get(),
+                                        strand_);
+  }
+#endif
 
+ private:
   std::unique_ptr<Rect> rect_;
+  // Runs the async calls of this object one at a time.
+  std::shared_ptr<node_binding::concurrency_limit> strand_ =
+      std::make_shared<node_binding::concurrency_limit>(1);
 };
 
-Napi::FunctionReference RectJs::constructor_;
-
 // static
 void RectJs::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(env, "Rect",
                                     {
                                         InstanceMethod("size", &RectJs::Size),
+                                        NODE_BINDING_BIND(&RectJs::ScaledSize)::
+                                            Descriptor("scaledSize"),
+#if (NAPI_VERSION > 3)
+                                        InstanceMethod("sizeAsync",
+                                                       &RectJs::SizeAsync),
+#endif
                                     });
 
-  constructor_ = Napi::Persistent(func);
-  constructor_.SuppressDestruct();
+  node_binding::SetConstructor<RectJs>(env, func);
 
   exports.Set("Rect", func);
 }
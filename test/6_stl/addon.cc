@@ -2,7 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "node_binding/channel.h"
+#include "node_binding/prepared_callback.h"
 #include "node_binding/promise.h"
+#include "node_binding/span.h"
 #include "node_binding/stl.h"
 #include "node_binding/typed_call.h"
 
@@ -22,6 +25,25 @@ std::vector<int> CLinSpace(int from, int to, int step) {
   return ret;
 }
 
+#if CXX_VER >= 201703
+size_t CStringViewLength(std::string_view str) { return str.size(); }
+
+std::string CConcat(std::string_view a, std::string_view b) {
+  std::string ret(a);
+  ret += b;
+  return ret;
+}
+#endif
+
+size_t CUtf16Length(std::u16string str) { return str.size(); }
+
+node_binding::latin1_string CToUpper(node_binding::latin1_string str) {
+  for (char& c : str) {
+    if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+  }
+  return str;
+}
+
 Napi::Value Sum(const Napi::CallbackInfo& info) {
   return node_binding::TypedCall(info, &CSum);
 }
@@ -30,6 +52,24 @@ Napi::Value LinSpace(const Napi::CallbackInfo& info) {
   return node_binding::TypedCall(info, &CLinSpace);
 }
 
+#if CXX_VER >= 201703
+Napi::Value StringViewLength(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CStringViewLength);
+}
+
+Napi::Value Concat(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CConcat);
+}
+#endif
+
+Napi::Value Utf16Length(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CUtf16Length);
+}
+
+Napi::Value ToUpper(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CToUpper);
+}
+
 #ifdef _NODE_BINDING_OBJECT
 using object = std::unordered_map<std::string, std::any>;
 
@@ -176,14 +216,19 @@ void delay_operation(std::string msg, long delay) {
   std::this_thread::sleep_for(std::chrono::milliseconds(delay));
 }
 
-void callbackTest(std::string data,
-                  int count,
-                  int delay,
-                  std::function<void(std::string, int)> callback) {
+// The callback is called on the thread of the env over and over, so it is
+// prepared once and its calls share a HandleScope.
+void callbackTest(
+    std::string data,
+    int count,
+    int delay,
+    node_binding::prepared_callback<void(std::string, int)> callback) {
   data.append(" - ").append(__FUNCTION__);
+  node_binding::callback_scope scope(callback.Env());
   while (count) {
     delay_operation(data, delay);
-    callback(data, count--);
+    callback(scope, data, count--);
+    if (callback.Env().IsExceptionPending()) break;
   }
 }
 
@@ -293,6 +338,86 @@ std::string promiseCallbackTest2(
   return "completed";
 }
 
+int promiseSquare(int value) { return value * value; }
+
+// Its arguments borrow for the call, so the job gets copies of them.
+std::string promiseJoin(const char* head, std::string_view tail,
+                        node_binding::byte_view bytes) {
+  int sum = 0;
+  for (uint8_t byte : bytes) sum += byte;
+  return std::string(head) + std::string(tail) + ":" + std::to_string(sum);
+}
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+// The calls which the producers below have made so far. JS waits for them
+// synchronously, so that none of them is run meanwhile.
+std::mutex produced_mutex;
+std::condition_variable produced_cv;
+int produced_calls = 0;
+
+template <typename Callback>
+void Produce(int count, Callback& callback) {
+  for (int i = 0; i < count; ++i) {
+    callback(i);
+    std::lock_guard<std::mutex> lock(produced_mutex);
+    ++produced_calls;
+    produced_cv.notify_all();
+  }
+}
+
+void resetProduced() {
+  std::lock_guard<std::mutex> lock(produced_mutex);
+  produced_calls = 0;
+}
+
+// Blocks JS until |count| calls are made or |timeout_ms| passes, and returns
+// the number of calls which are made.
+int waitProduced(int count, int timeout_ms) {
+  std::unique_lock<std::mutex> lock(produced_mutex);
+  produced_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                       [count] { return produced_calls >= count; });
+  return produced_calls;
+}
+
+using progress_callback = node_binding::
+    thread_safe_function<void(int), node_binding::tsfn_queue::coalesce_latest>;
+
+void coalescedProgressTest(int count, progress_callback progress) {
+  Produce(count, progress);
+}
+
+void boundedProgressTest(
+    int count,
+    node_binding::thread_safe_function<void(int),
+                                       node_binding::tsfn_queue::bounded<2>>
+        progress) {
+  Produce(count, progress);
+}
+
+void droppingProgressTest(
+    int count,
+    node_binding::thread_safe_function<
+        void(int), node_binding::tsfn_queue::drop_oldest<3>>
+        progress) {
+  Produce(count, progress);
+}
+
+int pipelinedCallbackTest(
+    int count,
+    node_binding::thread_safe_function<bool(int)> accept) {
+  std::vector<node_binding::reply<bool>> replies;
+  for (int i = 0; i < count; ++i) replies.push_back(accept.async_call(i));
+  int accepted = 0;
+  for (node_binding::reply<bool>& reply : replies) {
+    if (reply.get()) ++accepted;
+  }
+  return accepted;
+}
+
 void cancellablePromiseCallbackTest(
     std::string data,
     int count,
@@ -359,6 +484,52 @@ std::string cancellablePromiseCallbackTestWithCancelContext2(
   }
   return "completed";
 }
+
+std::string cancellableSleep(node_binding::cancel_context_ptr ctx, int ms) {
+  if (!ctx->sleep_for(std::chrono::milliseconds(ms))) return "woken up";
+  return "slept";
+}
+
+node_binding::async_generator<int> rangeStream(int count) {
+  return node_binding::async_generator<int>(
+      [count](node_binding::channel<int>& ch) {
+        for (int i = 0; i < count; ++i) {
+          if (!ch.Push(i)) return;
+        }
+      },
+      4);
+}
+
+// The number of items which the last countedStream() has pushed so far.
+std::atomic<int> stream_pushed(0);
+
+node_binding::async_generator<int> countedStream(int count, int capacity) {
+  stream_pushed = 0;
+  return node_binding::async_generator<int>(
+      [count](node_binding::channel<int>& ch) {
+        for (int i = 0; i < count; ++i) {
+          if (!ch.Push(i)) return;
+          ++stream_pushed;
+        }
+      },
+      capacity);
+}
+
+int streamPushed() { return stream_pushed; }
+
+node_binding::async_generator<int> failingStream(int count, bool by_throw) {
+  return node_binding::async_generator<int>(
+      [count, by_throw](node_binding::channel<int>& ch) {
+        for (int i = 0; i < count; ++i) {
+          if (!ch.Push(i)) return;
+        }
+#ifdef CXX_EXCEPTIONS
+        if (by_throw) throw std::runtime_error("stream failed");
+#endif
+        ch.Fail("stream failed");
+      },
+      4);
+}
 #endif
 
 #define FN_ENTRY(_env_, _functionName_) \
@@ -373,6 +544,12 @@ std::string cancellablePromiseCallbackTestWithCancelContext2(
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("sum", Napi::Function::New(env, Sum));
   exports.Set("linSpace", Napi::Function::New(env, LinSpace));
+#if CXX_VER >= 201703
+  exports.Set("stringViewLength", Napi::Function::New(env, StringViewLength));
+  exports.Set("concat", Napi::Function::New(env, Concat));
+#endif
+  exports.Set("utf16Length", Napi::Function::New(env, Utf16Length));
+  exports.Set("toUpper", Napi::Function::New(env, ToUpper));
 
 #ifdef _NODE_BINDING_OBJECT
   exports.Set(FN_ENTRY(env, getName));
@@ -389,6 +566,54 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
 #if (NAPI_VERSION > 3)
   exports.Set(PROMISE_FN_ENTRY(env, promiseCallbackTest));
   exports.Set(PROMISE_FN_ENTRY(env, promiseCallbackTest2));
+  exports.Set(PROMISE_FN_ENTRY(env, promiseSquare));
+  exports.Set(PROMISE_FN_ENTRY(env, promiseJoin));
+  exports.Set(PROMISE_FN_ENTRY(env, pipelinedCallbackTest));
+  exports.Set(PROMISE_FN_ENTRY(env, coalescedProgressTest));
+  exports.Set(PROMISE_FN_ENTRY(env, boundedProgressTest));
+  exports.Set(PROMISE_FN_ENTRY(env, droppingProgressTest));
+  exports.Set(FN_ENTRY(env, resetProduced));
+  exports.Set(FN_ENTRY(env, waitProduced));
+  exports.Set("tsfnHandlesCreated",
+              Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+                return Napi::Number::New(
+                    info.Env(),
+                    node_binding::internal::TsfnCache::Created(info.Env()));
+              }));
+  static std::shared_ptr<node_binding::thread_pool> pool =
+      std::make_shared<node_binding::thread_pool>(2);
+  exports.Set("poolPromiseSquare",
+              ::node_binding::ToPromise(env, promiseSquare, pool));
+  static std::shared_ptr<node_binding::job_scheduler> scheduler =
+      std::make_shared<node_binding::job_scheduler>();
+  exports.Set("scheduledPromiseSquare",
+              ::node_binding::ToPromise(
+                  env, promiseSquare,
+                  {scheduler, {node_binding::job_priority::kLow}}));
+  static std::shared_ptr<node_binding::concurrency_limit> limit =
+      std::make_shared<node_binding::concurrency_limit>(
+          1, 0, node_binding::overflow_policy::kReject);
+  exports.Set("limitedPromiseSquare",
+              ::node_binding::ToPromise(env, promiseSquare, limit));
+  exports.Set("limitedPromiseSquareLimit",
+              ::node_binding::ToJSValue(env, limit));
+  static std::shared_ptr<node_binding::concurrency_limit> sleep_limit =
+      std::make_shared<node_binding::concurrency_limit>(1, 1);
+  exports.Set("limitedCancellableSleep",
+              ::node_binding::ToCancellablePromise(env, cancellableSleep,
+                                                   sleep_limit));
+  exports.Set("limitedCancellableSleepLimit",
+              ::node_binding::ToJSValue(env, sleep_limit));
+  exports.Set("scheduledJobCount",
+              Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+                node_binding::job_priority priority =
+                    node_binding::job_priority::kHigh;
+                if (info[0].ToString().Utf8Value() == "low")
+                  priority = node_binding::job_priority::kLow;
+                return Napi::Number::New(
+                    info.Env(),
+                    static_cast<double>(scheduler->Stats(priority).jobs));
+              }));
   exports.Set(
       CANCELLABLE_PROMISE_FN_ENTRY(env, cancellablePromiseCallbackTest));
   exports.Set(
@@ -397,6 +622,21 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
       env, cancellablePromiseCallbackTestWithCancelContext));
   exports.Set(CANCELLABLE_PROMISE_FN_ENTRY(
       env, cancellablePromiseCallbackTestWithCancelContext2));
+  exports.Set(CANCELLABLE_PROMISE_FN_ENTRY(env, cancellableSleep));
+  exports.Set(FN_ENTRY(env, rangeStream));
+  exports.Set(FN_ENTRY(env, countedStream));
+  exports.Set(FN_ENTRY(env, streamPushed));
+  exports.Set(FN_ENTRY(env, failingStream));
+  exports.Set("lambdaPromiseAdd",
+              ::node_binding::ToPromise(
+                  env, [offset = std::make_unique<int>(40)](int value) {
+                    return value + *offset;
+                  }));
+  exports.Set("lambdaCancellableSleep",
+              ::node_binding::ToCancellablePromise(
+                  env, [](node_binding::cancel_context_ptr ctx, int ms) {
+                    return ctx->sleep_for(std::chrono::milliseconds(ms));
+                  }));
 
   exports.Set(PROMISE_FN_ENTRY(env, beginMoveTsfnCallbackTest));
   exports.Set(PROMISE_FN_ENTRY(env, endMoveTsfnCallbackTest));
@@ -0,0 +1,106 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <thread>
+
+#include "node_binding/shared_ring.h"
+#include "node_binding/span.h"
+#include "node_binding/stl.h"
+#include "node_binding/typed_array.h"
+#include "node_binding/typed_call.h"
+
+int CSum(const std::vector<int32_t>& vec) {
+  int ret = 0;
+  for (int32_t v : vec) {
+    ret += v;
+  }
+  return ret;
+}
+
+node_binding::typed_array<double> CScale(node_binding::typed_array<double> vec,
+                                         double k) {
+  for (double& v : vec) {
+    v *= k;
+  }
+  return vec;
+}
+
+node_binding::typed_array<uint8_t> CIota(int n) {
+  node_binding::typed_array<uint8_t> ret(n);
+  for (int i = 0; i < n; ++i) {
+    ret[i] = static_cast<uint8_t>(i);
+  }
+  return ret;
+}
+
+int CSpanSum(node_binding::span<const int32_t> vec) {
+  int ret = 0;
+  for (int32_t v : vec) {
+    ret += v;
+  }
+  return ret;
+}
+
+void CFill(node_binding::span<double> vec, double value) {
+  for (double& v : vec) {
+    v = value;
+  }
+}
+
+size_t CByteLength(node_binding::byte_view bytes) { return bytes.size(); }
+
+// Streams 0, 1, ..., count - 1 through a small ring, so that it wraps around
+// and the producer waits for JS while it is full.
+std::shared_ptr<node_binding::shared_ring<double>> CTickRing(int count) {
+  auto ring = std::make_shared<node_binding::shared_ring<double>>(64);
+  std::thread([ring, count] {
+    for (int i = 0; i < count; ++i) {
+      while (!ring->TryPush(i)) std::this_thread::yield();
+    }
+    ring->Close();
+  }).detach();
+  return ring;
+}
+
+Napi::Value Sum(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CSum);
+}
+
+Napi::Value Scale(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CScale);
+}
+
+Napi::Value Iota(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CIota);
+}
+
+Napi::Value SpanSum(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CSpanSum);
+}
+
+void Fill(const Napi::CallbackInfo& info) {
+  node_binding::TypedCall(info, &CFill);
+}
+
+Napi::Value ByteLength(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CByteLength);
+}
+
+Napi::Value TickRing(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CTickRing);
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("sum", Napi::Function::New(env, Sum));
+  exports.Set("scale", Napi::Function::New(env, Scale));
+  exports.Set("iota", Napi::Function::New(env, Iota));
+  exports.Set("spanSum", Napi::Function::New(env, SpanSum));
+  exports.Set("fill", Napi::Function::New(env, Fill));
+  exports.Set("byteLength", Napi::Function::New(env, ByteLength));
+  exports.Set("tickRing", Napi::Function::New(env, TickRing));
+  return exports;
+}
+
+NODE_API_MODULE(7_typed_array, Init)
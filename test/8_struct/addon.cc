@@ -0,0 +1,80 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "node_binding/property_key.h"
+#include "node_binding/stl.h"
+#include "node_binding/struct.h"
+#include "node_binding/typed_call.h"
+
+struct Size {
+  int width;
+  int height;
+};
+
+struct Item {
+  std::string name;
+  Size size;
+  std::vector<double> values;
+};
+
+NODE_BINDING_STRUCT(Size, width, height)
+NODE_BINDING_STRUCT(Item, name, size, values)
+
+int CArea(Size size) { return size.width * size.height; }
+
+Size CScale(Size size, int k) { return {size.width * k, size.height * k}; }
+
+int CTotalArea(const std::vector<Size>& sizes) {
+  int ret = 0;
+  for (const Size& size : sizes) {
+    ret += size.width * size.height;
+  }
+  return ret;
+}
+
+Item CRename(Item item, std::string name) {
+  item.name = name;
+  return item;
+}
+
+Napi::Value Area(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CArea);
+}
+
+Napi::Value Scale(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CScale);
+}
+
+Napi::Value TotalArea(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CTotalArea);
+}
+
+Napi::Value Rename(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CRename);
+}
+
+Napi::Value Label(const Napi::CallbackInfo& info) {
+  static const node_binding::property_key kLabel("label");
+  return info[0].As<Napi::Object>().Get(kLabel.Value(info.Env()));
+}
+
+// The number of key strings which the env has created so far.
+Napi::Value KeysCreated(const Napi::CallbackInfo& info) {
+  using KeyTable = node_binding::internal::EnvLocal<
+      node_binding::internal::PropertyKeyTable>;
+  size_t created = KeyTable::Get(info.Env()).created();
+  return Napi::Number::New(info.Env(), static_cast<double>(created));
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("area", Napi::Function::New(env, Area));
+  exports.Set("scale", Napi::Function::New(env, Scale));
+  exports.Set("totalArea", Napi::Function::New(env, TotalArea));
+  exports.Set("rename", Napi::Function::New(env, Rename));
+  exports.Set("label", Napi::Function::New(env, Label));
+  exports.Set("keysCreated", Napi::Function::New(env, KeysCreated));
+  return exports;
+}
+
+NODE_API_MODULE(8_struct, Init)
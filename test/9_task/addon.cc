@@ -0,0 +1,52 @@
+// Copyright (c) 2019 The NodeBinding Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdexcept>
+
+#include "node_binding/task.h"
+#include "node_binding/typed_call.h"
+
+node_binding::task<int> CSquareOnPool(int value) {
+  co_await node_binding::on_pool();
+  int ret = value * value;
+  co_await node_binding::on_main();
+  co_return ret;
+}
+
+node_binding::task<int> CSumOfSquares(int a, int b) {
+  int x = co_await CSquareOnPool(a);
+  int y = co_await CSquareOnPool(b);
+  co_return x + y;
+}
+
+node_binding::task<double> CAddToResolved(Napi::Value promise, double value) {
+  double resolved = co_await node_binding::js_promise<double>(promise);
+  co_return resolved + value;
+}
+
+node_binding::task<> CFailOnPool(std::string what) {
+  co_await node_binding::on_pool();
+  throw std::runtime_error(what);
+}
+
+Napi::Value SumOfSquares(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CSumOfSquares);
+}
+
+Napi::Value AddToResolved(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CAddToResolved);
+}
+
+Napi::Value FailOnPool(const Napi::CallbackInfo& info) {
+  return node_binding::TypedCall(info, &CFailOnPool);
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("sumOfSquares", Napi::Function::New(env, SumOfSquares));
+  exports.Set("addToResolved", Napi::Function::New(env, AddToResolved));
+  exports.Set("failOnPool", Napi::Function::New(env, FailOnPool));
+  return exports;
+}
+
+NODE_API_MODULE(9_task, Init)
@@ -8,4 +8,7 @@ node-gyp rebuild -C test/2_constructor
 node-gyp rebuild -C test/3_instance_accessor
 node-gyp rebuild -C test/4_instance_method
 node-gyp rebuild -C test/5_static_method
-node-gyp rebuild -C test/6_stl
\ No newline at end of file
+node-gyp rebuild -C test/6_stl
+node-gyp rebuild -C test/7_typed_array
+node-gyp rebuild -C test/8_struct
+node-gyp rebuild -C test/9_task
\ No newline at end of file
@@ -13,6 +13,9 @@ const test4 =
   require('./4_instance_method/build/Release/4_instance_method.node');
 const test5 = require('./5_static_method/build/Release/5_static_method.node');
 const test6 = require('./6_stl/build/Release/6_stl.node');
+const test7 = require('./7_typed_array/build/Release/7_typed_array.node');
+const test8 = require('./8_struct/build/Release/8_struct.node');
+const test9 = require('./9_task/build/Release/9_task.node');
 
 describe('0_function', () => {
   it('add(int arg0, int arg1) bind', () => {
@@ -24,6 +27,54 @@ describe('0_function', () => {
       test0.add(1, 2, 3);
     });
   });
+
+  it('NODE_BINDING_BIND(&CAdd) bind', () => {
+    assert.equal(test0.boundAdd.name, 'boundAdd');
+    assert.equal(test0.boundAdd(1, 2), 3);
+    assert.throws(() => {
+      test0.boundAdd(1, '2');
+    });
+    assert.equal(test0.setLastValue(5), undefined);
+    assert.equal(test0.getLastValue(), 5);
+  });
+
+  it('NODE_BINDING_BIND_WITH_CHECKS(&CAdd, unchecked) bind', () => {
+    assert.equal(test0.uncheckedAdd(1, 2), 3);
+    assert.equal(test0.uncheckedAdd(1.5, 2.5, 3), 4);
+  });
+
+  it('NODE_BINDING_BIND_BATCH(&CAdd) bind', () => {
+    let ret = test0.addBatch(new Float64Array([1, 2, 3]), [4, 5, 6]);
+    assert.ok(ret instanceof Float64Array);
+    assert.deepEqual(Array.from(ret), [5, 7, 9]);
+    assert.equal(test0.addBatch([], []).length, 0);
+    assert.deepEqual(test0.labelBatch(['a', 'b'], new Int32Array([1, 2])), [
+      'a1',
+      'b2',
+    ]);
+    assert.throws(() => {
+      test0.addBatch([1, 2], [1]);
+    });
+    assert.throws(() => {
+      test0.addBatch([1, '2'], [1, 2]);
+    });
+    assert.throws(() => {
+      test0.addBatch(1, 2);
+    });
+  });
+
+  it('sumOf(prepared_callback<double(int)> fn, int n) bind', () => {
+    assert.equal(test0.sumOf((i) => i * 2, 1000), 999000);
+    assert.equal(test0.sumOf(() => {}, 10), 0);
+    assert.throws(() => {
+      test0.sumOf(1, 10);
+    });
+    assert.throws(() => {
+      test0.sumOf(() => {
+        throw new Error('callback');
+      }, 10);
+    });
+  });
 });
 
 describe('1_default_argument', () => {
@@ -35,6 +86,25 @@ describe('1_default_argument', () => {
       test1.add(1, 2, 3);
     }, 'call add() more than 2 arguments is invalid.');
   });
+
+  it('Overloads(Overload(&CAdd, 1, 2), Overload(&CAdd, 2), &CAdd) bind',
+      () => {
+        assert.equal(test1.overloadedAdd(), 3);
+        assert.equal(test1.overloadedAdd(1), 3);
+        assert.equal(test1.overloadedAdd(1, 2), 3);
+        assert.throws(() => {
+          test1.overloadedAdd(1, 2, 3);
+        }, /Wrong number of arguments/);
+      });
+
+  it('overloads selected by the type of the first argument', () => {
+    assert.equal(test1.describe(1), 'number');
+    assert.equal(test1.describe('a'), 'string');
+    assert.throws(() => {
+      test1.describe(true);
+    }, /Type of arg0 is mismatched/);
+    assert.equal(test1.describe('ab', 3), 'ababab');
+  });
 });
 
 describe('2_constructor', () => {
@@ -45,6 +115,9 @@ describe('2_constructor', () => {
     assert.throws(() => {
       new test2.Point(1, 2, 3);
     });
+    assert.throws(() => {
+      new test2.Point(1, 'a');
+    }, TypeError);
   });
 });
 
@@ -59,6 +132,27 @@ describe('3_instance_accessor', () => {
     assert.equal(p2.x, 1);
     assert.equal(p2.y, 2);
   });
+
+  it('node_binding::NewInstance in worker_threads', (done) => {
+    const p = test3.makePoint(1, 2);
+    assert.ok(p instanceof test3.Point);
+    assert.equal(p.x + p.y, 3);
+
+    const {Worker} = require('worker_threads');
+    const addon = require.resolve(
+      './3_instance_accessor/build/Release/3_instance_accessor.node');
+    const worker = new Worker(`
+      const {parentPort} = require('worker_threads');
+      const test3 = require(${JSON.stringify(addon)});
+      const p = test3.makePoint(3, 4);
+      parentPort.postMessage(p instanceof test3.Point && p.x + p.y);
+    `, {eval: true});
+    worker.once('message', (sum) => {
+      assert.equal(sum, 7);
+      done();
+    });
+    worker.once('error', done);
+  });
 });
 
 describe('4_instance_method', () => {
@@ -66,6 +160,21 @@ describe('4_instance_method', () => {
     const r = new test4.Rect(5, 2);
     assert.equal(r.size(), 10);
   });
+
+  it('NODE_BINDING_BIND(&RectJs::ScaledSize) bind', () => {
+    const r = new test4.Rect(5, 2);
+    assert.equal(r.scaledSize(3), 30);
+    assert.throws(() => {
+      r.scaledSize.call({}, 3);
+    });
+  });
+
+  it('node_binding::TypedCallAsync(&Rect::size)', () => {
+    const r = new test4.Rect(5, 2);
+    return Promise.all([r.sizeAsync(), r.sizeAsync()]).then((sizes) => {
+      assert.deepEqual(sizes, [10, 10]);
+    });
+  });
 });
 
 describe('5_static_method', () => {
@@ -90,6 +199,24 @@ describe('6_stl', () => {
     assert.deepEqual(test6.linSpace(1, 5, 1), [1, 2, 3, 4]);
   });
 
+  if (test6.stringViewLength) {
+    it('std::string_view bind', () => {
+      assert.equal(test6.stringViewLength(Buffer.from('abc')), 3);
+      assert.equal(test6.stringViewLength(new Uint8Array(5)), 5);
+      assert.equal(test6.stringViewLength('\u00e9'), 2);
+      assert.equal(test6.concat('foo', 'bar'), 'foobar');
+      const long = 'x'.repeat(10000);
+      assert.equal(test6.concat(long, 'y'), long + 'y');
+    });
+  }
+
+  it('std::u16string, latin1_string bind', () => {
+    assert.equal(test6.utf16Length('\u{1f600}'), 2);
+    assert.equal(test6.utf16Length('a'.repeat(1000)), 1000);
+    assert.equal(test6.toUpper('abc-123'), 'ABC-123');
+    assert.equal(test6.toUpper('z'.repeat(300)), 'Z'.repeat(300));
+  });
+
   function test_obj(obj, name) {
     assert.equal(obj.name, name);
     assert.equal(obj[name + '_bool_array'].length, 4);
@@ -341,6 +468,297 @@ describe('6_stl', () => {
       }
     });
 
+  it('node_binding::ToPromise - many promises at once', () => {
+    const values = Array.from({length: 1000}, (_, i) => i);
+    return Promise.all(values.map((i) => test6.promiseSquare(i)))
+      .then((results) => {
+        assert.deepEqual(results, values.map((i) => i * i));
+      });
+  }).timeout(timeout);
+
+  it('node_binding::ToPromise - borrowed arguments are copied', () => {
+    const values = Array.from({length: 100}, (_, i) => i);
+    const promises = values.map((i) => {
+      const bytes = Buffer.from([i, 1, 2]);
+      const promise = test6.promiseJoin('h'.repeat(1000) + i, 't' + i, bytes);
+      bytes.fill(0);
+      return promise;
+    });
+    return Promise.all(promises).then((results) => {
+      assert.deepEqual(results, values.map((i) =>
+        'h'.repeat(1000) + i + 't' + i + ':' + (i + 3)));
+    });
+  }).timeout(timeout);
+
+  it('node_binding::ToPromise - node_binding::thread_pool', () => {
+    const values = Array.from({length: 1000}, (_, i) => i);
+    return Promise.all(values.map((i) => test6.poolPromiseSquare(i)))
+      .then((results) => {
+        assert.deepEqual(results, values.map((i) => i * i));
+      });
+  }).timeout(timeout);
+
+  it('node_binding::ToPromise - node_binding::job_scheduler', () => {
+    const values = Array.from({length: 100}, (_, i) => i);
+    const low = test6.scheduledJobCount('low');
+    const high = test6.scheduledJobCount('high');
+    return Promise.all(values.map((i) => i % 2 ?
+      test6.scheduledPromiseSquare(i) :
+      test6.scheduledPromiseSquare(i, {priority: 'high'})))
+      .then((results) => {
+        assert.deepEqual(results, values.map((i) => i * i));
+        assert.equal(test6.scheduledJobCount('low') - low, 50);
+        assert.equal(test6.scheduledJobCount('high') - high, 50);
+      });
+  }).timeout(timeout);
+
+  it('node_binding::job_scheduler - options out of range', () => {
+    assert.throws(() => {
+      test6.scheduledPromiseSquare(3, {priority: 'urgent'});
+    }, TypeError);
+    return Promise.all([
+      test6.scheduledPromiseSquare(3, {deadline: 1e15}),
+      test6.scheduledPromiseSquare(4, {deadline: Infinity}),
+    ]).then((results) => {
+      assert.deepEqual(results, [9, 16]);
+    });
+  }).timeout(timeout);
+
+  it('node_binding::ToPromise - node_binding::concurrency_limit', () => {
+    const first = test6.limitedPromiseSquare(3);
+    assert.equal(test6.limitedPromiseSquareLimit.inFlight, 1);
+    return test6.limitedPromiseSquare(4)
+      .then(() => assert.fail('expected to be rejected'), (e) => {
+        assert.equal(e.status, 'busy');
+        return first;
+      })
+      .then((result) => {
+        assert.equal(result, 9);
+      });
+  }).timeout(timeout);
+
+  it('node_binding::concurrency_limit - canceled jobs leave the queue',
+    () => {
+      const limit = test6.limitedCancellableSleepLimit;
+      const first = test6.limitedCancellableSleep(100);
+      const canceled = test6.limitedCancellableSleep(1);
+      assert.equal(limit.queued, 1);
+      canceled.cancel();
+      assert.equal(limit.queued, 0);
+      // The queue holds one job, which a canceled one no longer takes.
+      const next = test6.limitedCancellableSleep(1);
+      assert.equal(limit.queued, 1);
+      return Promise.all([
+        first.promise,
+        canceled.promise.then(() => assert.fail('expected to be canceled'),
+          (e) => assert.equal(e.status, 'canceled')),
+        next.promise,
+      ]).then(([firstResult, , nextResult]) => {
+        assert.equal(firstResult, 'slept');
+        assert.equal(nextResult, 'slept');
+      });
+    }).timeout(timeout);
+
+  it('node_binding::ToCancellablePromise - timeout', () => {
+    return test6.cancellableSleep(60000, {timeout: 50}).promise
+      .then(() => assert.fail('expected to be canceled'), (e) => {
+        assert.equal(e.status, 'canceled');
+      });
+  }).timeout(timeout);
+
+  it('node_binding::ToCancellablePromise - AbortSignal', () => {
+    const signal = {
+      aborted: false,
+      addEventListener(type, listener) {
+        this.listener = listener;
+      },
+    };
+    const ret = test6.cancellableSleep(60000, {signal});
+    setTimeout(() => {
+      signal.aborted = true;
+      signal.listener();
+    }, 50);
+    return ret.promise
+      .then(() => assert.fail('expected to be canceled'), (e) => {
+        assert.equal(e.status, 'canceled');
+      });
+  }).timeout(timeout);
+
+  it('node_binding::ToCancellablePromise - AbortSignal listener removal',
+    () => {
+      const listeners = new Set();
+      const signal = {
+        aborted: false,
+        addEventListener(type, listener) {
+          listeners.add(listener);
+        },
+        removeEventListener(type, listener) {
+          listeners.delete(listener);
+        },
+      };
+      const calls = Array.from({length: 10},
+        () => test6.cancellableSleep(1, {signal}).promise);
+      assert.equal(listeners.size, 10);
+      return Promise.all(calls).then(() => {
+        assert.equal(listeners.size, 0);
+      });
+    }).timeout(timeout);
+
+  it('node_binding::ToCancellablePromise - AbortSignal listener removal on cancel',
+    () => {
+      const listeners = new Set();
+      const signal = {
+        aborted: false,
+        addEventListener(type, listener) {
+          listeners.add(listener);
+        },
+        removeEventListener(type, listener) {
+          listeners.delete(listener);
+        },
+      };
+      const ret = test6.cancellableSleep(60000, {signal});
+      assert.equal(listeners.size, 1);
+      ret.cancel();
+      return ret.promise
+        .then(() => assert.fail('expected to be canceled'), (e) => {
+          assert.equal(e.status, 'canceled');
+          assert.equal(listeners.size, 0);
+        });
+    }).timeout(timeout);
+
+  it('node_binding::thread_safe_function<bool(int)>::async_call', () => {
+    return test6.pipelinedCallbackTest(10, (num) => num % 2 == 0)
+      .then((result) => {
+        assert.equal(result, 5);
+      });
+  }).timeout(timeout);
+
+  it('node_binding::thread_safe_function - same handler again', () => {
+    const accept = (num) => num % 2 == 0;
+    const created = test6.tsfnHandlesCreated();
+    let calls = Promise.resolve();
+    for (let i = 0; i < 20; ++i) {
+      calls = calls.then(() => test6.pipelinedCallbackTest(10, accept))
+        .then((result) => {
+          assert.equal(result, 5);
+          assert.equal(test6.tsfnHandlesCreated() - created, 1);
+        });
+    }
+    return calls;
+  }).timeout(timeout);
+
+  // Collects the calls of a progress callback until it is called with
+  // |count| - 1, while |test| produces them.
+  const collectProgress = (test, count, wait) => {
+    const received = [];
+    let last;
+    const lastCall = new Promise((resolve) => last = resolve);
+    test6.resetProduced();
+    const produced = test(count, (num) => {
+      received.push(num);
+      if (num == count - 1) last();
+    });
+    // No call runs while JS is blocked.
+    const made = test6.waitProduced(count, wait);
+    return Promise.all([produced, lastCall]).then(() => [made, received]);
+  };
+
+  it('node_binding::tsfn_queue::coalesce_latest', () => {
+    const count = 10000;
+    return collectProgress(test6.coalescedProgressTest, count, timeout / 2)
+      .then(([made, received]) => {
+        assert.equal(made, count);
+        assert.ok(received.length < count);
+        assert.equal(received[received.length - 1], count - 1);
+      });
+  }).timeout(timeout);
+
+  it('node_binding::tsfn_queue::bounded', () => {
+    const count = 10;
+    return collectProgress(test6.boundedProgressTest, count, 200)
+      .then(([made, received]) => {
+        // The producer is blocked once 2 calls are queued.
+        assert.equal(made, 2);
+        assert.deepEqual(received, Array.from({length: count}, (_, i) => i));
+      });
+  }).timeout(timeout);
+
+  it('node_binding::tsfn_queue::drop_oldest', () => {
+    const count = 10;
+    return collectProgress(test6.droppingProgressTest, count, timeout / 2)
+      .then(([made, received]) => {
+        assert.equal(made, count);
+        assert.deepEqual(received, [count - 3, count - 2, count - 1]);
+      });
+  }).timeout(timeout);
+
+  it('node_binding::ToPromise - lambda with a move-only capture', () => {
+    return test6.lambdaPromiseAdd(2).then((result) => {
+      assert.equal(result, 42);
+    });
+  }).timeout(timeout);
+
+  it('node_binding::ToCancellablePromise - lambda', () => {
+    const ret = test6.lambdaCancellableSleep(60000);
+    ret.cancel();
+    return ret.promise
+      .then(() => assert.fail('expected to be canceled'), (e) => {
+        assert.equal(e.status, 'canceled');
+      });
+  }).timeout(timeout);
+
+  it('node_binding::async_generator<int>', async () => {
+    const items = [];
+    for await (const item of test6.rangeStream(100)) {
+      items.push(item);
+    }
+    assert.deepEqual(items, Array.from({length: 100}, (_, i) => i));
+  }).timeout(timeout);
+
+  it('node_binding::async_generator<int> - break', async () => {
+    const items = [];
+    for await (const item of test6.rangeStream(1000000)) {
+      items.push(item);
+      if (items.length == 3) break;
+    }
+    assert.deepEqual(items, [0, 1, 2]);
+  }).timeout(timeout);
+
+  it('node_binding::async_generator<int> - backpressure', async () => {
+    const capacity = 2;
+    const stream = test6.countedStream(100, capacity);
+    assert.deepEqual(await stream.next(), {value: 0, done: false});
+    // Once one item is read, the producer fills the buffer and then waits
+    // rather than runs ahead while JS doesn't read.
+    while (test6.streamPushed() < 1 + capacity) {
+      await new Promise((resolve) => setTimeout(resolve, 10));
+    }
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    assert.equal(test6.streamPushed(), 1 + capacity);
+
+    const items = [0];
+    for await (const item of stream) items.push(item);
+    assert.deepEqual(items, Array.from({length: 100}, (_, i) => i));
+    assert.equal(test6.streamPushed(), 100);
+  }).timeout(timeout);
+
+  for (const byThrow of [false, true]) {
+    it(`node_binding::async_generator<int> - ${
+      byThrow ? 'throw' : 'channel::Fail()'}`, async () => {
+      const items = [];
+      try {
+        for await (const item of test6.failingStream(3, byThrow)) {
+          items.push(item);
+        }
+        assert.fail('expected to be rejected');
+      } catch (e) {
+        assert.equal(e.status, 'error');
+        assert.equal(e.result, 'stream failed');
+      }
+      assert.deepEqual(items, [0, 1, 2]);
+    }).timeout(timeout);
+  }
+
   describe(
     'node_binding::ToCancellablePromise - node_binding::thread_safe_function<?> bind',
     () => {
@@ -532,4 +950,171 @@ describe('6_stl', () => {
           .timeout(timeout)
       }
     });
-});
\ No newline at end of file
+});
+
+describe('7_typed_array', () => {
+  it('std::vector<int32_t> from Int32Array bind', () => {
+    assert.equal(test7.sum([1, 2, 3]), 6);
+    assert.equal(test7.sum(new Int32Array([1, 2, 3])), 6);
+    assert.equal(test7.sum(new Int32Array([0, 1, 2, 3]).subarray(1)), 6);
+    assert.throws(() => {
+      test7.sum(new Float64Array([1, 2, 3]));
+    });
+    assert.throws(() => {
+      test7.sum([1, 2, '3']);
+    }, /Type of arg0 is mismatched/);
+  });
+
+  it('node_binding::typed_array<double> bind', () => {
+    const ret = test7.scale(new Float64Array([1, 2, 3]), 2);
+    assert.ok(ret instanceof Float64Array);
+    assert.deepEqual(Array.from(ret), [2, 4, 6]);
+    assert.deepEqual(Array.from(test7.scale([1, 2, 3], 3)), [3, 6, 9]);
+    assert.equal(test7.scale(new Float64Array(0), 2).length, 0);
+    assert.throws(() => {
+      test7.scale(new Float32Array([1, 2, 3]), 2);
+    });
+  });
+
+  it('node_binding::span<const int32_t> bind', () => {
+    assert.equal(test7.spanSum(new Int32Array([1, 2, 3])), 6);
+    assert.equal(test7.spanSum(new Int32Array([0, 1, 2, 3]).subarray(1)), 6);
+    assert.equal(test7.spanSum(new Int32Array([1, 2, 3]).buffer), 6);
+    assert.throws(() => {
+      test7.spanSum([1, 2, 3]);
+    });
+    assert.throws(() => {
+      test7.spanSum(new Uint32Array([1, 2, 3]));
+    });
+    assert.throws(() => {
+      test7.spanSum(new DataView(new ArrayBuffer(8), 2, 4));
+    });
+  });
+
+  it('node_binding::span<double> bind', () => {
+    const arr = new Float64Array(3);
+    test7.fill(arr, 1.5);
+    assert.deepEqual(Array.from(arr), [1.5, 1.5, 1.5]);
+  });
+
+  it('node_binding::byte_view bind', () => {
+    assert.equal(test7.byteLength(Buffer.from('abc')), 3);
+    assert.equal(test7.byteLength(new Float64Array(2)), 16);
+    assert.equal(test7.byteLength(new DataView(new ArrayBuffer(8), 2, 5)), 5);
+    assert.equal(test7.byteLength(new ArrayBuffer(4)), 4);
+  });
+
+  it('node_binding::typed_array<uint8_t> bind', () => {
+    const ret = test7.iota(4);
+    assert.ok(ret instanceof Uint8Array);
+    assert.deepEqual(Array.from(ret), [0, 1, 2, 3]);
+  });
+
+  it('node_binding::shared_ring<double> by Atomics', async () => {
+    const count = 10000;
+    const ring = test7.tickRing(count);
+    const {header, items, capacity, layout} = ring;
+    assert.ok(items instanceof Float64Array);
+    assert.equal(capacity, 64);
+    assert.equal(Atomics.load(header, layout.capacity), capacity);
+    let expected = 0;
+    for (;;) {
+      const closed = Atomics.load(header, layout.closed);
+      const write = Atomics.load(header, layout.write);
+      let read = Atomics.load(header, layout.read);
+      if (read === write) {
+        if (closed) break;
+        await ring.wait();
+        continue;
+      }
+      for (; read !== write; read = (read + 1) | 0) {
+        assert.equal(items[read & (capacity - 1)], expected++);
+      }
+      Atomics.store(header, layout.read, read);
+    }
+    assert.equal(expected, count);
+  }).timeout(10000);
+
+  it('node_binding::shared_ring<double> by read()', async () => {
+    const count = 10000;
+    const ring = test7.tickRing(count);
+    let expected = 0;
+    for (;;) {
+      const closed = Atomics.load(ring.header, ring.layout.closed);
+      const ticks = ring.read();
+      for (const tick of ticks) assert.equal(tick, expected++);
+      if (ticks.length == 0) {
+        if (closed) break;
+        await ring.wait();
+      }
+    }
+    assert.equal(expected, count);
+  }).timeout(10000);
+});
+
+describe('8_struct', () => {
+  it('NODE_BINDING_STRUCT bind', () => {
+    assert.equal(test8.area({width: 2, height: 3}), 6);
+    assert.deepEqual(test8.scale({width: 2, height: 3}, 2),
+        {width: 4, height: 6});
+    assert.deepEqual(Object.keys(test8.scale({height: 3, width: 2}, 1)),
+        ['width', 'height']);
+    assert.throws(() => {
+      test8.area({width: 2});
+    });
+    assert.throws(() => {
+      test8.area({width: 2, height: '3'});
+    });
+  });
+
+  it('nested NODE_BINDING_STRUCT bind', () => {
+    assert.equal(
+        test8.totalArea([{width: 1, height: 2}, {width: 3, height: 4}]), 14);
+    const item = {name: 'a', size: {width: 1, height: 2}, values: [1.5]};
+    assert.deepEqual(test8.rename(item, 'b'),
+        {name: 'b', size: {width: 1, height: 2}, values: [1.5]});
+  });
+
+  it('node_binding::property_key is created once per env', () => {
+    assert.equal(test8.label({label: 'a'}), 'a');
+    const created = test8.keysCreated();
+    for (let i = 0; i < 10; ++i) {
+      assert.equal(test8.label({label: i}), i);
+    }
+    assert.equal(test8.keysCreated(), created);
+  });
+
+  it('NODE_BINDING_STRUCT reuses its field keys', () => {
+    const item = {name: 'a', size: {width: 1, height: 2}, values: [1.5]};
+    test8.rename(item, 'b');
+    const created = test8.keysCreated();
+    for (let i = 0; i < 10; ++i) {
+      assert.equal(test8.rename(item, 'c' + i).name, 'c' + i);
+      assert.deepEqual(test8.scale({width: i, height: 1}, 2),
+          {width: i * 2, height: 2});
+    }
+    assert.equal(test8.keysCreated(), created);
+  });
+});
+
+describe('9_task', () => {
+  it('node_binding::task<int> bind', () => {
+    return test9.sumOfSquares(3, 4).then((result) => {
+      assert.equal(result, 25);
+    });
+  });
+
+  it('node_binding::js_promise<double>', () => {
+    return test9.addToResolved(Promise.resolve(1.5), 2).then((result) => {
+      assert.equal(result, 3.5);
+    });
+  });
+
+  it('node_binding::task<> with an exception', () => {
+    return test9.failOnPool('failed').then(
+        () => assert.fail('expected to be rejected'), (e) => {
+          assert.equal(e.status, 'error');
+          assert.equal(e.result, 'failed');
+        });
+  });
+});